@@ -0,0 +1,347 @@
+/** \file
+ * Throughput benchmark for NSort.
+ *
+ * Times the sort strategies NSort::sort, NSort::stable_sort,
+ * NSort::radix_sort, PNSort::sort and NSort::resort for the direct,
+ * uniform_grid (1D/2D/3D), pivot, w_species and remap maps over a range of
+ * problem sizes and particle sizes.  All strategies sort the same (random)
+ * input.  For each combination the average time of a single sort is reported
+ * together with the achieved items/s and bytes/s (the number of bytes in the
+ * sorted range), one row per strategy, so that the strategies can be compared
+ * directly.
+ *
+ * resort is timed on a previously sorted range in which move_fraction of the
+ * items were perturbed (particles are displaced by up to half a unit in each
+ * direction), which models the re-sort after a single time step.  PNSort uses
+ * xylose::pthreadCache, whose number of threads is given by the environment
+ * variable NUM_PTHREADS.
+ *
+ * Usage:
+ *    benchNSort [min_exponent=4] [max_exponent=8] [max_megabytes=2048]
+ *
+ * Problem sizes run from 10^min_exponent to 10^max_exponent.  Combinations
+ * whose working set (the particles plus the pristine, sorted and perturbed
+ * copies that the repetitions are restored from) would exceed max_megabytes
+ * are skipped.
+ */
+
+#include <xylose/Timer.h>
+#include <xylose/Vector.h>
+#include <xylose/Dimensions.hpp>
+#include <xylose/random/Kiss.hpp>
+
+#include <xylose/nsort/NSort.h>
+#include <xylose/nsort/PNSort.h>
+#include <xylose/nsort/map/direct.h>
+#include <xylose/nsort/map/pivot.h>
+#include <xylose/nsort/map/uniform_grid.h>
+#include <xylose/nsort/map/w_species.h>
+#include <xylose/nsort/map/remap.h>
+#include <xylose/nsort/map/args.h>
+
+#include <iostream>
+#include <iomanip>
+#include <vector>
+#include <string>
+#include <algorithm>
+#include <cstdlib>
+#include <cmath>
+
+
+namespace bench {
+  using xylose::Vector;
+  using xylose::V3;
+  using xylose::Dimensions;
+
+  /** Number of species used for the w_species maps. */
+  const unsigned int n_species = 4u;
+
+  /** Number of distinct values used for the direct map. */
+  const int n_direct = 1024;
+
+  /** Minimum wall time (in seconds) spent on each combination. */
+  const double min_time = 0.25;
+
+  /** Fraction of the items that are perturbed before each resort. */
+  const double move_fraction = 0.01;
+
+  /** The timed sort strategies. */
+  enum Method {
+    SORT,
+    STABLE_SORT,
+    RADIX_SORT,
+    PNSORT,
+    RESORT,
+    N_METHODS
+  };
+
+  const char * const method_name[N_METHODS] = {
+    "sort",
+    "stable_sort",
+    "radix_sort",
+    "PNSort",
+    "resort"
+  };
+
+  /** Particle with a position, species and n_words of payload.  The payload
+   * only adds to the number of bytes that must be moved by the sort. */
+  template < unsigned int n_words >
+  struct Particle {
+    Vector<double,3u> x;
+    int species;
+    double payload[n_words];
+  };
+
+  template < unsigned int n_words >
+  inline const Vector<double,3u> & position( const Particle<n_words> & p ) {
+    return p.x;
+  }
+
+  template < unsigned int n_words >
+  inline const int & species( const Particle<n_words> & p ) {
+    return p.species;
+  }
+
+  /** Uniform grid over [-50,50)^3 with size() cells per direction (0 for unused
+   * directions). */
+  struct Grid {
+    Vector<double,3u> m_x0;
+    Vector<double,3u> m_dx;
+    Vector<unsigned int,3u> m_size;
+
+    Grid( const Vector<unsigned int,3u> & size )
+      : m_x0( -50.0 ), m_dx( 1.0 ), m_size( size ) {
+      for ( unsigned int i = 0u; i < 3u; ++i )
+        if ( size[i] > 0u )
+          m_dx[i] = 100.0 / size[i];
+    }
+
+    const Vector<double,3u> & x0() const { return m_x0; }
+    const Vector<double,3u> & dx() const { return m_dx; }
+    const Vector<unsigned int,3u> & size() const { return m_size; }
+  };
+
+  /** direct map over the values [0,n_direct). */
+  struct direct_n : xylose::nsort::map::direct {
+    int getNumberValues() const { return n_direct; }
+  };
+
+  template < typename P >
+  void init( std::vector<P> & pv, const int & n ) {
+    xylose::random::Kiss rng;
+    pv.resize(n);
+    for ( int i = 0; i < n; ++i ) {
+      pv[i].x = V3( 100.0*rng.rand() - 50.0,
+                    100.0*rng.rand() - 50.0,
+                    100.0*rng.rand() - 50.0 );
+      pv[i].species = static_cast<int>( rng.rand() * n_species ) % n_species;
+      std::fill( pv[i].payload,
+                 pv[i].payload + sizeof(pv[i].payload)/sizeof(double),
+                 double(i) );
+    }
+  }
+
+  inline void init( std::vector<int> & v, const int & n ) {
+    xylose::random::Kiss rng;
+    v.resize(n);
+    for ( int i = 0; i < n; ++i )
+      v[i] = static_cast<int>( rng.rand() * n_direct ) % n_direct;
+  }
+
+  /** Displace a particle by up to half a unit in each direction. */
+  template < unsigned int n_words >
+  void perturb( Particle<n_words> & p, xylose::random::Kiss & rng ) {
+    p.x += V3( rng.rand() - 0.5, rng.rand() - 0.5, rng.rand() - 0.5 );
+  }
+
+  /** Move an integer to the next value. */
+  inline void perturb( int & v, xylose::random::Kiss & ) {
+    v = ( v + 1 ) % n_direct;
+  }
+
+  /** Perturb move_fraction of the items of v. */
+  template < typename T >
+  void perturb( std::vector<T> & v ) {
+    xylose::random::Kiss rng;
+    const int n_move = static_cast<int>( move_fraction * v.size() );
+    for ( int i = 0; i < n_move; ++i )
+      perturb( v[ static_cast<int>( rng.rand() * v.size() ) % v.size() ], rng );
+  }
+
+  /** Sort work with the given strategy. */
+  template < typename T, typename Map >
+  void sort_with( const Method & method,
+                  xylose::nsort::NSort<Map> & sorter,
+                  xylose::nsort::PNSort<Map> & psorter,
+                  std::vector<T> & work,
+                  const Map & map ) {
+    switch ( method ) {
+      case SORT:
+        sorter.sort( work.begin(), work.end(), map );
+        break;
+      case STABLE_SORT:
+        sorter.stable_sort( work.begin(), work.end(), map );
+        break;
+      case RADIX_SORT:
+        sorter.radix_sort( work.begin(), work.end(), map );
+        break;
+      case PNSORT:
+        psorter.sort( work.begin(), work.end(), map );
+        break;
+      case RESORT:
+        sorter.resort( work.begin(), work.end(), map );
+        break;
+      default:
+        break;
+    }
+  }
+
+  /** Times the given sort strategy and returns the average time of a single
+   * sort.  Each repetition restores the input first so that every sort sees
+   * the same data; only the sort itself is timed.
+   * @param orig
+   *    The unsorted input.
+   * @param sorted
+   *    orig after sorting (used to prime resort).
+   * @param moved
+   *    sorted after perturbing some of the items (the input of resort).
+   */
+  template < typename T, typename Map >
+  double time_method( const Method & method,
+                      const Map & map,
+                      const std::vector<T> & orig,
+                      const std::vector<T> & sorted,
+                      const std::vector<T> & moved ) {
+    std::vector<T> work = orig;
+    xylose::nsort::NSort<Map> sorter( map.getNumberValues() );
+    xylose::nsort::PNSort<Map> psorter( map.getNumberValues() );
+
+    xylose::Timer timer( xylose::Timer::CUMMULATIVE );
+    /* the first (untimed) repetition is the warm up (allocates the scratch
+     * space and touches all pages). */
+    int reps = -1;
+    do {
+      if ( method == RESORT ) {
+        /* build the bucket table of the sorted range; then perturb. */
+        std::copy( sorted.begin(), sorted.end(), work.begin() );
+        sorter.sort( work.begin(), work.end(), map );
+        std::copy( moved.begin(), moved.end(), work.begin() );
+      } else
+        std::copy( orig.begin(), orig.end(), work.begin() );
+
+      if ( reps < 0 )
+        sort_with( method, sorter, psorter, work, map );
+      else {
+        timer.start();
+        sort_with( method, sorter, psorter, work, map );
+        timer.stop();
+      }
+      ++reps;
+    } while ( reps == 0 || timer.dt < min_time );
+
+    return timer.dt / reps;
+  }
+
+  /** Times each sort strategy with the given map and prints one row of
+   * results per strategy. */
+  template < typename T, typename Map >
+  void run( const std::string & name,
+            const Map & map,
+            const int & n,
+            const double & max_bytes ) {
+    const double bytes = double(n) * sizeof(T);
+    /* the input, the sorted and the perturbed copies and the work range. */
+    if ( 4.0 * bytes > max_bytes )
+      return;
+
+    std::vector<T> orig, sorted, moved;
+    init( orig, n );
+    sorted = orig;
+    xylose::nsort::NSort<Map>( map.getNumberValues() )
+      .sort( sorted.begin(), sorted.end(), map );
+    moved = sorted;
+    perturb( moved );
+
+    for ( int m = 0; m < N_METHODS; ++m ) {
+      const double t =
+        time_method( static_cast<Method>(m), map, orig, sorted, moved );
+      std::cout << std::setw(16) << std::left  << name
+                << std::setw(12) << method_name[m]
+                << std::setw(8)  << std::right << sizeof(T)
+                << std::setw(12) << n
+                << std::setw(8)  << map.getNumberValues()
+                << std::setw(14) << std::scientific << std::setprecision(3) << t
+                << std::setw(14) << ( n / t )
+                << std::setw(14) << ( bytes / t )
+                << std::fixed << std::endl;
+    }
+  }
+
+  /** Runs every map for particles of the given size. */
+  template < unsigned int n_words >
+  void run_particles( const int & n, const double & max_bytes ) {
+    using namespace xylose::nsort::map;
+    typedef Particle<n_words> P;
+
+    typedef Dimensions<0u>          D1;
+    typedef Dimensions<0u,1u>       D2;
+    typedef Dimensions<0u,1u,2u>    D3;
+
+    const Grid g1( V3(4096u,   0u,  0u) );
+    const Grid g2( V3(  64u,  64u,  0u) );
+    const Grid g3( V3(  16u,  16u, 16u) );
+
+    run<P>( "grid1D", uniform_grid<Grid,D1>(g1), n, max_bytes );
+    run<P>( "grid2D", uniform_grid<Grid,D2>(g2), n, max_bytes );
+    run<P>( "grid3D", uniform_grid<Grid,D3>(g3), n, max_bytes );
+    run<P>( "grid3D+species",
+            w_species< uniform_grid<Grid,D3> >( make_arg(n_species, g3) ),
+            n, max_bytes );
+
+    run<P>( "pivot1D", pivot<D1>(), n, max_bytes );
+    run<P>( "pivot3D", pivot<D3>(), n, max_bytes );
+    run<P>( "pivot3D+species",
+            w_species< pivot<D3> >( n_species ), n, max_bytes );
+
+    /* fold the upper half-space of the octants onto the lower. */
+    remap< pivot<D3> > rmap;
+    for ( unsigned int i = 0u; i < rmap.number_values; ++i )
+      rmap.m_remap[i] = i % 4u;
+    run<P>( "remap(pivot3D)", rmap, n, max_bytes );
+  }
+
+  /** Runs the integer sort with the direct map. */
+  inline void run_direct( const int & n, const double & max_bytes ) {
+    run<int>( "direct", direct_n(), n, max_bytes );
+  }
+}
+
+
+int main( int argc, char ** argv ) {
+  int min_exp = 4, max_exp = 8;
+  double max_mb = 2048.0;
+  if ( argc > 1 ) min_exp = std::atoi( argv[1] );
+  if ( argc > 2 ) max_exp = std::atoi( argv[2] );
+  if ( argc > 3 ) max_mb  = std::atof( argv[3] );
+
+  const double max_bytes = max_mb * 1024.0 * 1024.0;
+
+  std::cout << std::setw(16) << std::left  << "# map"
+            << std::setw(12) << "method"
+            << std::setw(8)  << std::right << "bytes"
+            << std::setw(12) << "N"
+            << std::setw(8)  << "values"
+            << std::setw(14) << "s/sort"
+            << std::setw(14) << "items/s"
+            << std::setw(14) << "bytes/s" << std::endl;
+
+  for ( int e = min_exp; e <= max_exp; ++e ) {
+    const int n = static_cast<int>( std::pow( 10.0, e ) + 0.5 );
+    bench::run_direct( n, max_bytes );
+    bench::run_particles<1u>( n, max_bytes );
+    bench::run_particles<5u>( n, max_bytes );
+    bench::run_particles<13u>( n, max_bytes );
+  }
+
+  return 0;
+}
@@ -0,0 +1,352 @@
+/** \file
+ * Statistical quality and throughput benchmark for the random number
+ * generators.
+ *
+ * For each generator (Kiss, Crappy, MersenneTwister, Philox, SplitMix64,
+ * Xoshiro256ss and PCG64) this measures
+ *    - chi^2 equidistribution over 1024 bins,
+ *    - the lag-1 serial correlation,
+ *    - Marsaglia's birthday spacings (m=512, 2^24 days),
+ *    - the gap test on [0.25,0.5),
+ *    - randInt/s, rand/s, randExc53/s and fill/s for uint32 and double.
+ *
+ * The results are printed as tab separated rows
+ *    generator  test  statistic  p-value
+ * (the p-value is -1 for the throughput numbers).  p-values outside
+ * [1e-6, 1-1e-6] are flagged on stderr; some generators (e.g. Crappy) are
+ * known to be poor.  These tests are quick screens (a few 10^7 numbers), not
+ * a replacement for the batteries that the generator unit tests can write
+ * input files for (--generate-random).
+ *
+ * Usage:
+ *    randomQuality [--tsv file] [generator ...]
+ *
+ * Without generator names all generators are measured.  With --tsv the rows
+ * are also appended to the given file so that runs may be compared later.
+ */
+
+#include <xylose/Timer.h>
+#include <xylose/random/Kiss.hpp>
+#include <xylose/random/Crappy.hpp>
+#include <xylose/random/MersenneTwister.hpp>
+#include <xylose/random/Philox.hpp>
+#include <xylose/random/SplitMix64.hpp>
+#include <xylose/random/Xoshiro256ss.hpp>
+#include <xylose/random/PCG64.hpp>
+
+#include <boost/cstdint.hpp>
+#include <boost/math/special_functions/gamma.hpp>
+
+#include <iostream>
+#include <fstream>
+#include <sstream>
+#include <string>
+#include <vector>
+#include <set>
+#include <algorithm>
+#include <cmath>
+
+
+namespace quality {
+  using boost::uint32_t;
+
+  /** Outcome of a single measurement. */
+  struct Result {
+    std::string test;
+    double statistic;
+    /** p-value of the statistic (negative for throughput numbers). */
+    double p;
+
+    Result( const std::string & test,
+            const double & statistic,
+            const double & p = -1.0 )
+      : test(test), statistic(statistic), p(p) { }
+  };
+
+  typedef std::vector<Result> Results;
+
+  /** Make sure that the results of the timed loops are not optimized away.
+   */
+  template < typename T >
+  inline void keep( const T & t ) {
+    static volatile T sink;
+    sink = t;
+  }
+
+  /** P(X >= chi2) for a chi^2 distribution with dof degrees of
+   * freedom. */
+  inline double chi2_p( const double & chi2, const double & dof ) {
+    return boost::math::gamma_q( 0.5 * dof, 0.5 * chi2 );
+  }
+
+  /** chi^2 of the observed counts against the expected. */
+  inline double chi2( const std::vector<double> & observed,
+                      const std::vector<double> & expected ) {
+    double c = 0.0;
+    for ( unsigned int i = 0u; i < observed.size(); ++i ) {
+      const double d = observed[i] - expected[i];
+      c += d * d / expected[i];
+    }
+    return c;
+  }
+
+  /** A uniform index in [0,n) (from randExc so that generators with a
+   * rand_max below 2^32-1 may be tested too). */
+  template < typename RNG >
+  inline uint32_t uniform_index( RNG & r, const uint32_t & n ) {
+    return static_cast<uint32_t>( r.randExc() * n );
+  }
+
+
+
+  /* ****   STATISTICAL TESTS   **** */
+
+  /** Equidistribution:  chi^2 of n numbers over 1024 equal bins. */
+  template < typename RNG >
+  inline Result uniformity( RNG & r, const int & n = 10000000 ) {
+    const uint32_t nb = 1024u;
+    std::vector<double> obs(nb, 0.0), exp(nb, double(n) / nb);
+    for ( int i = 0; i < n; ++i )
+      obs[ uniform_index(r, nb) ] += 1.0;
+
+    const double c = chi2( obs, exp );
+    return Result( "chi2-uniformity", c, chi2_p( c, nb - 1 ) );
+  }
+
+  /** Serial correlation:  the lag-1 correlation coefficient of n
+   * uniform numbers.  sqrt(n) times the coefficient is approximately a
+   * standard normal variate, of which the two-sided p-value is given.
+   */
+  template < typename RNG >
+  inline Result serial_correlation( RNG & r, const int & n = 10000000 ) {
+    double prev = r.rand(), first = prev;
+    double s1 = 0, s2 = 0, s12 = 0;
+    for ( int i = 1; i < n; ++i ) {
+      const double u = r.rand();
+      s1  += prev;
+      s2  += prev * prev;
+      s12 += prev * u;
+      prev = u;
+    }
+    /* close the loop so that each number is in two products. */
+    s1  += prev;
+    s2  += prev * prev;
+    s12 += prev * first;
+
+    const double corr = ( n * s12 - s1 * s1 ) / ( n * s2 - s1 * s1 );
+    const double z = corr * std::sqrt( double(n) );
+    return Result( "serial-correlation", corr,
+                   erfc( std::abs(z) / std::sqrt(2.0) ) );
+  }
+
+  /** Birthday spacings (Marsaglia):  m = 512 birthdays in a year of
+   * 2^24 days.  The number of repeated spacings between the sorted
+   * birthdays is approximately Poissonian with mean m^3/(4 2^24) = 2.
+   * chi^2 of the counts of n_samples years over the values
+   * 0,1,...,5,>=6.  */
+  template < typename RNG >
+  inline Result birthday_spacings( RNG & r, const int & n_samples = 5000 ) {
+    const int m = 512;
+    const uint32_t days = 1u << 24u;
+    const double lambda = double(m) * m * m / ( 4.0 * days );
+    const int nb = 7;
+
+    std::vector<double> obs(nb, 0.0), exp(nb, 0.0);
+    std::vector<uint32_t> b(m), s(m);
+    for ( int k = 0; k < n_samples; ++k ) {
+      for ( int i = 0; i < m; ++i )
+        b[i] = uniform_index( r, days );
+      std::sort( b.begin(), b.end() );
+
+      s[0] = b[0];
+      for ( int i = 1; i < m; ++i )
+        s[i] = b[i] - b[i-1];
+      std::sort( s.begin(), s.end() );
+
+      int repeats = 0;
+      for ( int i = 1; i < m; ++i )
+        repeats += ( s[i] == s[i-1] );
+      obs[ std::min( repeats, nb - 1 ) ] += 1.0;
+    }
+
+    double p = std::exp( -lambda ), rest = 1.0;
+    for ( int i = 0; i < nb - 1; ++i ) {
+      exp[i] = p * n_samples;
+      rest -= p;
+      p *= lambda / (i + 1);
+    }
+    exp[nb-1] = rest * n_samples;
+
+    const double c = chi2( obs, exp );
+    return Result( "birthday-spacings", c, chi2_p( c, nb - 1 ) );
+  }
+
+  /** Gap test:  the lengths of the runs of numbers outside [0.25,0.5)
+   * between numbers inside it are geometrically distributed.  chi^2 of
+   * n_gaps gaps over the lengths 0,1,...,19,>=20. */
+  template < typename RNG >
+  inline Result gaps( RNG & r, const int & n_gaps = 1000000 ) {
+    const double a = 0.25, b = 0.5, p = b - a;
+    const int nb = 21;
+
+    std::vector<double> obs(nb, 0.0), exp(nb, 0.0);
+    for ( int k = 0; k < n_gaps; ++k ) {
+      int len = 0;
+      for ( double u = r.randExc(); u < a || u >= b; u = r.randExc() )
+        ++len;
+      obs[ std::min( len, nb - 1 ) ] += 1.0;
+    }
+
+    double q = p;
+    for ( int i = 0; i < nb - 1; ++i ) {
+      exp[i] = q * n_gaps;
+      q *= 1.0 - p;
+    }
+    exp[nb-1] = std::pow( 1.0 - p, nb - 1 ) * n_gaps;
+
+    const double c = chi2( obs, exp );
+    return Result( "gap", c, chi2_p( c, nb - 1 ) );
+  }
+
+
+
+  /* ****   THROUGHPUT   **** */
+
+  /** Numbers per second from randInt. */
+  template < typename RNG >
+  inline Result randInt_rate( RNG & r, const unsigned long & n = 50000000UL ) {
+    uint32_t junk = 0u;
+    xylose::Timer timer;
+    timer.start();
+    for ( unsigned long i = 0; i < n; ++i )
+      junk ^= r.randInt();
+    timer.stop();
+
+    keep( junk );
+    return Result( "randInt/s", n / timer.dt );
+  }
+
+  /** Numbers per second from rand. */
+  template < typename RNG >
+  inline Result rand_rate( RNG & r, const unsigned long & n = 50000000UL ) {
+    double junk = 0.0;
+    xylose::Timer timer;
+    timer.start();
+    for ( unsigned long i = 0; i < n; ++i )
+      junk += r.rand();
+    timer.stop();
+
+    keep( junk );
+    return Result( "rand/s", n / timer.dt );
+  }
+
+  /** Numbers per second from randExc53. */
+  template < typename RNG >
+  inline Result rand53_rate( RNG & r, const unsigned long & n = 50000000UL ) {
+    double junk = 0.0;
+    xylose::Timer timer;
+    timer.start();
+    for ( unsigned long i = 0; i < n; ++i )
+      junk += r.randExc53();
+    timer.stop();
+
+    keep( junk );
+    return Result( "randExc53/s", n / timer.dt );
+  }
+
+  /** Numbers per second from fill (integers and doubles). */
+  template < typename RNG, typename T >
+  inline Result fill_rate( RNG & r, const std::string & name,
+                           const unsigned long & n = 50000000UL ) {
+    std::vector<T> buf( 1u << 14u );
+    T junk = T();
+    const unsigned long n_blocks = n / buf.size();
+    xylose::Timer timer;
+    timer.start();
+    for ( unsigned long i = 0; i < n_blocks; ++i ) {
+      r.fill( buf.begin(), buf.end() );
+      junk += buf[i % buf.size()];
+    }
+    timer.stop();
+
+    keep( junk );
+    return Result( name, n_blocks * buf.size() / timer.dt );
+  }
+
+
+
+  /** Print (and optionally save) the results for a generator. */
+  inline void report( const std::string & label, const Results & results,
+                      std::ostream * tsv ) {
+    std::ostringstream rows;
+    for ( unsigned int i = 0u; i < results.size(); ++i )
+      rows << label << '\t' << results[i].test << '\t'
+           << results[i].statistic << '\t' << results[i].p << '\n';
+
+    std::cout << rows.str() << std::flush;
+    if ( tsv )
+      *tsv << rows.str() << std::flush;
+  }
+
+  /** Run all measurements for a generator. */
+  template < typename RNG >
+  inline void run( const std::string & label, std::ostream * tsv ) {
+    Results results;
+    {
+      RNG r;
+      results.push_back( uniformity(r) );
+      results.push_back( serial_correlation(r) );
+      results.push_back( birthday_spacings(r) );
+      results.push_back( gaps(r) );
+    }
+
+    for ( unsigned int i = 0u; i < results.size(); ++i )
+      if ( ! ( results[i].p > 1e-6 && results[i].p < 1.0 - 1e-6 ) )
+        std::cerr << label << ":  suspicious p-value for " << results[i].test
+                  << " (" << results[i].p << ')' << std::endl;
+
+    {
+      RNG r;
+      results.push_back( randInt_rate(r) );
+      results.push_back( rand_rate(r) );
+      results.push_back( rand53_rate(r) );
+      results.push_back( fill_rate<RNG,uint32_t>(r, "fill(uint32)/s") );
+      results.push_back( fill_rate<RNG,double>(r, "fill(double)/s") );
+    }
+
+    report( label, results, tsv );
+  }
+}
+
+
+int main( int argc, char ** argv ) {
+  using namespace xylose::random;
+
+  std::ofstream tsv_file;
+  std::set<std::string> selected;
+  for ( int i = 1; i < argc; ++i ) {
+    const std::string arg( argv[i] );
+    if ( arg == "--tsv" && i + 1 < argc )
+      tsv_file.open( argv[++i], std::ios::app );
+    else
+      selected.insert( arg );
+  }
+  std::ostream * tsv = tsv_file.is_open() ? &tsv_file : NULL;
+
+#define RUN_GENERATOR( G ) \
+  if ( selected.empty() || selected.count( #G ) ) \
+    quality::run< G >( #G, tsv )
+
+  std::cout << "# generator\ttest\tstatistic\tp-value" << std::endl;
+  RUN_GENERATOR( Kiss );
+  RUN_GENERATOR( Crappy );
+  RUN_GENERATOR( MersenneTwister );
+  RUN_GENERATOR( Philox );
+  RUN_GENERATOR( SplitMix64 );
+  RUN_GENERATOR( Xoshiro256ss );
+  RUN_GENERATOR( PCG64 );
+
+#undef RUN_GENERATOR
+
+  return 0;
+}
@@ -136,7 +136,8 @@ namespace xylose {
      * instance's tasks are completed before returning.
      */
     inline void joinAll() {
-      joinAll( NoOpGather() );
+      NoOpGather g;
+      joinAll( g );
     }
 
     /** Task gatherer.  This function makes sure that all of this
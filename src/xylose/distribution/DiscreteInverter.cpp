@@ -28,10 +28,6 @@
 namespace xylose {
   namespace distribution {
 
-    template < typename RNG, bool B >
-    RNG DiscreteInverter<RNG,B>::global_RNG;
-
-
     template < typename RNG, bool B >
     template < typename PairIter >
     void DiscreteInverter<RNG,B>::resetProbabilityMap( const PairIter & begin,
@@ -54,6 +50,83 @@ namespace xylose {
       using detail::MultiplyFirst;
       std::for_each(IntP.begin(), IntP.end(), MultiplyFirst(1./IntP_total));
       prob_map = std::map<double,double>(IntP.begin(), IntP.end());
+      compileTables();
+    }
+
+    template < typename RNG, bool B >
+    void DiscreteInverter<RNG,B>::compileTables() {
+      typedef std::map<double,double>::const_iterator Iter;
+
+      const unsigned int n = prob_map.size();
+      F.clear();
+      values.clear();
+      for ( Iter i = prob_map.begin(); i != prob_map.end(); ++i ) {
+        F.push_back( i->first );
+        values.push_back( i->second );
+      }
+
+      /* guide table with one entry per value. */
+      guide.resize( std::max(n, 1u) );
+      unsigned int k = 0u;
+      for ( unsigned int j = 0u; j < guide.size(); ++j ) {
+        const double Fj = double(j) / guide.size();
+        while ( k < n && F[k] < Fj )
+          ++k;
+        guide[j] = k;
+      }
+
+      /* the alias table:  start with the probabilities scaled by n (so that
+       * the mean is 1). */
+      alias_prob.resize(n);
+      alias_index.resize(n);
+      for ( unsigned int i = 0u; i < n; ++i )
+        alias_prob[i] = ( F[i] - ( i > 0u ? F[i-1] : 0.0 ) ) * n;
+
+      std::vector<unsigned int> small, large;
+      for ( unsigned int i = 0u; i < n; ++i ) {
+        alias_index[i] = i;
+        if ( alias_prob[i] < 1.0 )
+          small.push_back(i);
+        else
+          large.push_back(i);
+      }
+
+      /* fill each under-full column with an over-full one. */
+      while ( !small.empty() && !large.empty() ) {
+        const unsigned int s = small.back(), l = large.back();
+        small.pop_back();
+
+        alias_index[s] = l;
+        alias_prob[l] -= 1.0 - alias_prob[s];
+        if ( alias_prob[l] < 1.0 ) {
+          large.pop_back();
+          small.push_back(l);
+        }
+      }
+
+      /* whatever remains is full (up to round-off). */
+      for ( unsigned int i = 0u; i < small.size(); ++i )
+        alias_prob[ small[i] ] = 1.0;
+      for ( unsigned int i = 0u; i < large.size(); ++i )
+        alias_prob[ large[i] ] = 1.0;
+    }
+
+    template < typename RNG, bool B >
+    template < typename OutputIterator >
+    OutputIterator DiscreteInverter<RNG,B>::generate_n( OutputIterator out,
+                                                        std::size_t n ) const {
+      RNG & g = getRNG();
+      const double scale = 1. / (static_cast<double>(RNG::rand_max) + 1.);
+      const std::size_t block = 256u;
+      random::uint32_t buf[block];
+      while ( n > 0u ) {
+        const std::size_t m = std::min( n, block );
+        g.randInts( buf, m );
+        for ( std::size_t i = 0u; i < m; ++i, ++out )
+          *out = alias_value( buf[i] * scale );
+        n -= m;
+      }
+      return out;
     }
 
 
@@ -23,10 +23,12 @@
  * Generic discrete distribution inverter.
  *
  * This class is optimal for inverting distributions that have discrete data
- * and for which memory efficiency is a requirement.  It should be noted that
- * the generic continuous distribution inverter (the Inverter class in
- * Inverter.h) can handle discrete data sets as long as the sampling rate is
- * high enough--the definition of 'high enough' must be determined by testing.  
+ * and for which memory efficiency is a requirement.  Random values are drawn
+ * in O(1) time with an alias table (see DiscreteInverter::alias_value).  It
+ * should be noted that the generic continuous distribution inverter (the
+ * Inverter class in Inverter.h) can handle discrete data sets as long as the
+ * sampling rate is high enough--the definition of 'high enough' must be
+ * determined by testing.  
  */
 
 /** \example invertdistro/discrete/vector.cpp
@@ -42,11 +44,14 @@
 #define xylose_distribution_DiscreteInverter_h
 
 #include <xylose/random/Kiss.hpp>
+#include <xylose/random/ThreadRNG.hpp>
 #include <xylose/distribution/detail/pair.h>
 
 #include <map>
+#include <vector>
 #include <fstream>
 #include <iterator>
+#include <cstddef>
 
 namespace xylose {
   namespace distribution {
@@ -62,8 +67,11 @@ namespace xylose {
      *
      * @tparam operator_returns_discrete
      *    Whether operator() should return value that exactly matches one of the
-     *    x-axis input values (i.e. calls discrete_value).  Otherwise, the
+     *    x-axis input values (i.e. calls alias_value).  Otherwise, the
      *    values are linearly interpolated between neighboring data points.
+     *    Note that alias_value gives the same distribution as
+     *    discrete_value, but not the same (monotone in the uniform variate)
+     *    sequence of values for the same random number seed.
      *    Note:  the false case has not been tested extensively nor has it been
      *    proven to be correct.
      *    [Default true]
@@ -79,16 +87,27 @@ namespace xylose {
       /** \f$ F(v') \circeq \int_0^{v'} P(v) \; dv \rightarrow v' \f$. */
       std::map<double,double> prob_map;
 
-      /** Reference to the random number generator that is used for this
-       * distribution. */
-      RNG & rng;
+      /** The keys of prob_map in a flat array:  F[k] = F(values[k]). */
+      std::vector<double> F;
 
+      /** The values of prob_map in a flat array (the x-axis values with
+       * non-zero probability, in order). */
+      std::vector<double> values;
 
-      /* STATIC STORAGE */
-    private:
-      /** The global generator to use for all distributions if a specific
-       * reference is not passed in at constructor time. */
-      static RNG global_RNG;
+      /** Guide table (Chen and Asau, 1974) into F:  guide[j] is the first k
+       * with F[k] >= j / guide.size(). */
+      std::vector<unsigned int> guide;
+
+      /** Probability of keeping column i of the alias table (rather than
+       * taking its alias). */
+      std::vector<double> alias_prob;
+
+      /** Alias of each column of the alias table. */
+      std::vector<unsigned int> alias_index;
+
+      /** The random number generator that is used for this distribution
+       * (NULL for the generator of the calling thread). */
+      RNG * rng;
 
 
       /* MEMBER FUNCTIONS */
@@ -96,8 +115,10 @@ namespace xylose {
 
       /** Copy onstructor (copying from a specific probability map). */
       DiscreteInverter( const std::map<double,double> prob_map,
-                        RNG & rng = DiscreteInverter::global_RNG )
-        : prob_map( prob_map ), rng( rng ) { }
+                        RNG & rng = random::ThreadRNG<RNG>::per_thread() )
+        : prob_map( prob_map ), rng( random::ThreadRNG<RNG>::bind(rng) ) {
+        compileTables();
+      }
 
       /** DiscreteInverter constructor, taking data from memory.
        *
@@ -107,12 +128,14 @@ namespace xylose {
        *    Ending std::pair<double,double>-iterator of in-memory data.
        * @param rng
        *    A reference to the random number generator that will be used by
-       *    this distribution.
+       *    this distribution [default:  the generator of the thread that
+       *    draws, see random::ThreadRNG].
        */
       template < typename Iter >
       DiscreteInverter( const Iter & begin,
                         const Iter & end,
-                        RNG & rng = DiscreteInverter::global_RNG ) : rng(rng) {
+                        RNG & rng = random::ThreadRNG<RNG>::per_thread() )
+        : rng( random::ThreadRNG<RNG>::bind(rng) ) {
         resetProbabilityMap( begin, end );
       }
 
@@ -124,10 +147,12 @@ namespace xylose {
        *    Name of file from which to read data.
        * @param rng
        *    A reference to the random number generator that will be used by
-       *    this distribution.
+       *    this distribution [default:  the generator of the thread that
+       *    draws, see random::ThreadRNG].
        */
       DiscreteInverter( const std::string & filename,
-                        RNG & rng = DiscreteInverter::global_RNG ) : rng(rng) {
+                        RNG & rng = random::ThreadRNG<RNG>::per_thread() )
+        : rng( random::ThreadRNG<RNG>::bind(rng) ) {
         typedef std::istream_iterator< detail::pair<double,double> > IIter;
         std::ifstream in(filename.c_str());
         resetProbabilityMap( IIter(in), IIter() );
@@ -142,10 +167,12 @@ namespace xylose {
        *    Stream from which to read data.
        * @param rng
        *    A reference to the random number generator that will be used by
-       *    this distribution.
+       *    this distribution [default:  the generator of the thread that
+       *    draws, see random::ThreadRNG].
        */
       DiscreteInverter( std::istream & in,
-                        RNG & rng = DiscreteInverter::global_RNG ) : rng(rng) {
+                        RNG & rng = random::ThreadRNG<RNG>::per_thread() )
+        : rng( random::ThreadRNG<RNG>::bind(rng) ) {
         typedef std::istream_iterator< detail::pair<double,double> > IIter;
         resetProbabilityMap( IIter(in), IIter() );
       }
@@ -157,41 +184,80 @@ namespace xylose {
       void resetProbabilityMap( const PairIter & begin, const PairIter & end );
 
       /** Get a random number from this distribution.
-       * This calls leverarm(double).  This is now essentially the same function
-       * as lever().
+       * This calls alias_value(double) (or leverarm(double) if
+       * operator_returns_discrete is false).
+       * @see discrete().
        * @see lever().
-       * @see lever(double).
        */
       double operator() (void) const {
         if (operator_returns_discrete)
-          return discrete_value( rng.rand() );
+          return alias_value( getRNG().randExc() );
         else
-          return leverarm( rng.rand() );
+          return leverarm( getRNG().rand() );
       }
 
       /** Get a random number from this distribution.
        * Calls leverarm(double).
        */
       double lever() const {
-        return leverarm( rng.rand() );
+        return leverarm( getRNG().rand() );
       }
 
       /** Get a random number from this distribution.
-       * Calls discrete_value.
+       * Calls alias_value.
        */
       double discrete( ) const {
-        return discrete_value( rng.rand() );
+        return alias_value( getRNG().randExc() );
+      }
+
+      /** Store n random (discrete) values from this distribution at out and
+       * return the end of the output.  The uniform variates are drawn in
+       * blocks (see random::detail::RandBase::randInts) and give the same
+       * values as n calls to discrete().
+       */
+      template < typename OutputIterator >
+      OutputIterator generate_n( OutputIterator out, std::size_t n ) const;
+
+      /** Fill [first,last) with random (discrete) values from this
+       * distribution.  @see generate_n. */
+      template < typename ForwardIterator >
+      void fill( ForwardIterator first, ForwardIterator last ) const {
+        generate_n( first, std::distance( first, last ) );
+      }
+
+      /** The random number generator used by this distribution. */
+      RNG & getRNG() const {
+        return random::ThreadRNG<RNG>::select(rng);
       }
 
       /** Sample the inverted distribution:  values returned will be exactly
        * those given in the original distribution (no interpolation done).
        */
       double discrete_value( const double & rf ) const {
-        std::map<double,double>::const_iterator i = prob_map.lower_bound( rf );
-        if ( i == prob_map.end() )
-          return prob_map.rbegin()->second;
+        /* first k with F[k] >= rf */
+        unsigned int k = guess(rf);
+        while ( k < F.size() && F[k] < rf )
+          ++k;
+
+        if ( k == F.size() )
+          return values.back();
         else
-          return i->second;
+          return values[k];
+      }
+
+      /** Sample the distribution with the alias table (Walker's method):
+       * the integer part of rf*n selects a column of the table and the
+       * fractional part decides between the column and its alias.  This
+       * takes O(1) time independent of the number of values, but, unlike
+       * discrete_value, is not monotonic in rf.
+       * @param rf
+       *     A fraction in the range [0,1).
+       */
+      double alias_value( const double & rf ) const {
+        const double x = rf * values.size();
+        const unsigned int i = static_cast<unsigned int>( x );
+        return ( x - i ) < alias_prob[i] ? values[i]
+                                         : values[ alias_index[i] ];
       }
 
       /** Sample the inverted distribution.
@@ -202,21 +268,22 @@ namespace xylose {
        *     A fraction in the range [0,1] (inclusive).
        */
       double leverarm(const double & rf) const {
-        typedef std::map<double,double>::const_iterator Iter;
+        /* first k with F[k] > rf */
+        unsigned int k = guess(rf);
+        while ( k < F.size() && F[k] <= rf )
+          ++k;
 
-        Iter i = prob_map.upper_bound( rf );
-        if ( i == prob_map.begin() )
+        if ( k == 0u )
           /* No extrapolation, just return first item. */
-          return i->second;
-        else if ( i == prob_map.end() )
+          return values[0];
+        else if ( k == F.size() )
           /* No extrapolation, just return the last item. */
-          return prob_map.rbegin()->second;
+          return values.back();
         else {
-          /* Interpolate between i and i-1. */
-          Iter i0 = i;
-          --i0;
-          return ( i->second*(rf - i0->first) + i0->second*(i->first - rf) ) /
-                              ( i->first - i0->first );
+          /* Interpolate between k and k-1. */
+          const unsigned int k0 = k - 1u;
+          return ( values[k]*(rf - F[k0]) + values[k0]*(F[k] - rf) ) /
+                              ( F[k] - F[k0] );
         }
       }
 
@@ -229,6 +296,23 @@ namespace xylose {
       const std::map<double,double> & invertedDistribution() const {
         return prob_map;
       }
+
+    private:
+      /** Copy prob_map into the flat arrays and build the guide and alias
+       * tables. */
+      void compileTables();
+
+      /** A lower bound (from the guide table) of the index of the first
+       * F[k] >= rf. */
+      unsigned int guess( const double & rf ) const {
+        const double x = rf * guide.size();
+        if ( x <= 0.0 )
+          return 0u;
+        else if ( x >= guide.size() )
+          return guide.back();
+        else
+          return guide[ static_cast<unsigned int>(x) ];
+      }
     };
 
   }/* namespace xylose::distribution */
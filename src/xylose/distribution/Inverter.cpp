@@ -65,6 +65,7 @@
 
 #include <stdexcept>
 #include <cstring>
+#include <algorithm>
 
 #if defined(_MSC_VER)
   #undef min
@@ -74,10 +75,6 @@
 namespace xylose {
   namespace distribution {
 
-    template < typename RNG >
-    RNG Inverter<RNG>::global_RNG;
-
-
     template < typename RNG >
     inline void Inverter<RNG>::copyLq( const int & that_L,
                                        const double * that_q ) {
@@ -99,7 +96,7 @@ namespace xylose {
     inline Inverter<RNG>::Inverter( const int & _qLen,
                                     const double * _q,
                                     RNG & rng )
-      : L(0), q(NULL), rng(rng) {
+      : L(0), q(NULL), rng( random::ThreadRNG<RNG>::bind(rng) ) {
       copyLq(_qLen-1, q);
     }
 
@@ -110,7 +107,7 @@ namespace xylose {
                                     const double & min, const double & max,
                                     const int & nbins,
                                     RNG & rng )
-      : L(nbins), q(NULL), rng(rng) {
+      : L(nbins), q(NULL), rng( random::ThreadRNG<RNG>::bind(rng) ) {
 
       if (L <= 1) {
         THROW(std::runtime_error,"Inverter needs more than one bin.");
@@ -180,5 +177,27 @@ namespace xylose {
     }
 
 
+    template < typename RNG >
+    template < typename OutputIterator >
+    inline OutputIterator Inverter<RNG>::generate_n( OutputIterator out,
+                                                     std::size_t n ) const {
+      RNG & g = getRNG();
+      const double rexc_scale = 1. / (static_cast<double>(RNG::rand_max) + 1.);
+      const std::size_t block = 256u;
+      random::uint32_t ibuf[block];
+      double buf[block];
+      while ( n > 0u ) {
+        const std::size_t m = std::min( n, block );
+        g.randInts( ibuf, m );
+        for ( std::size_t i = 0u; i < m; ++i )
+          buf[i] = ibuf[i] * rexc_scale;
+        leverarm( buf, m, buf );
+        out = std::copy( buf, buf + m, out );
+        n -= m;
+      }
+      return out;
+    }
+
+
   }/* namespace xylose::distribution */
 }/* namespace xylose */
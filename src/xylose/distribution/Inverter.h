@@ -83,6 +83,10 @@
 #define xylose_distribution_Inverter_h
 
 #include <xylose/random/Kiss.hpp>
+#include <xylose/random/ThreadRNG.hpp>
+
+#include <iterator>
+#include <cstddef>
 
 #if defined(_MSC_VER)
   #undef min
@@ -113,16 +117,9 @@ namespace xylose {
     private:
       int L;
       double * q; /* length L + 1 */
-      /** Reference to the random number generator that is used for this
-       * distribution. */
-      RNG & rng;
-
-
-      /* STATIC STORAGE */
-    private:
-      /** The global generator to use for all distributions if a specific
-       * reference is not passed in at constructor time. */
-      static RNG global_RNG;
+      /** The random number generator that is used for this distribution
+       * (NULL for the generator of the calling thread). */
+      RNG * rng;
 
 
       /* MEMBER FUNCTIONS */
@@ -136,7 +133,7 @@ namespace xylose {
       /** Copy onstructor (copying from a specific inverted distribution. */
       inline Inverter( const int & _qLen,
                        const double * _q,
-                       RNG & rng = Inverter::global_RNG );
+                       RNG & rng = random::ThreadRNG<RNG>::per_thread() );
 
       /** Inverter constructor.
        * This is templated constructor to allow for various types of distribution
@@ -164,13 +161,14 @@ namespace xylose {
        *     Number of bins to use in distribution inversion [Default  100].
        * @param rng
        *     A reference to the random number generator that will be used by
-       *     this distribution.
+       *     this distribution [default:  the generator of the thread that
+       *     draws, see random::ThreadRNG].
        */
       template < typename DistroFunctor >
       inline Inverter( const DistroFunctor & distro,
                        const double & min, const double & max,
                        const int & nbins = 100,
-                       RNG & rng = Inverter::global_RNG );
+                       RNG & rng = random::ThreadRNG<RNG>::per_thread() );
 
       /** Destructor frees memory for q-array. */
       inline ~Inverter();
@@ -182,7 +180,7 @@ namespace xylose {
        * @see lever(double).
        */
       inline double operator() (void) const {
-        return leverarm( rng.randExc() );
+        return leverarm( getRNG().randExc() );
       }
 
       /** Sample the inverted distribution.
@@ -198,11 +196,50 @@ namespace xylose {
         return q[ri] + (q[ri+1] - q[ri]) * (r - ri);
       }
 
+      /** Sample the inverted distribution at n fractions:
+       * out[i] = leverarm(rf[i]).  out may be the same array as rf.
+       * This is the loop that sample() runs over blocks of uniform variates;
+       * it is kept free of calls and branches so that the compiler can
+       * vectorize it (with gathers for the table lookups where the target
+       * has them).
+       */
+      inline void leverarm( const double * rf, std::size_t n,
+                            double * out ) const {
+        const double * const q = this->q;
+        const double dL = L;
+        for ( std::size_t i = 0u; i < n; ++i ) {
+          const double r = rf[i] * dL;
+          const int ri = int(r);
+          out[i] = q[ri] + (q[ri+1] - q[ri]) * (r - ri);
+        }
+      }
+
       /** Get a random number from this distribution.
        * Calls leverarm(double).
        */
       inline double lever() const {
-        return leverarm( rng.randExc() );
+        return leverarm( getRNG().randExc() );
+      }
+
+      /** Store n random numbers from this distribution at out and return the
+       * end of the output.  The uniform variates are drawn in blocks (see
+       * random::detail::RandBase::randInts) and inverted by
+       * leverarm(const double*,std::size_t,double*); the results are the
+       * same as those of n calls to operator().
+       */
+      template < typename OutputIterator >
+      inline OutputIterator generate_n( OutputIterator out, std::size_t n ) const;
+
+      /** Fill [first,last) with random numbers from this distribution.
+       * @see generate_n. */
+      template < typename ForwardIterator >
+      inline void sample( ForwardIterator first, ForwardIterator last ) const {
+        generate_n( first, std::distance( first, last ) );
+      }
+
+      /** The random number generator used by this distribution. */
+      inline RNG & getRNG() const {
+        return random::ThreadRNG<RNG>::select(rng);
       }
 
       /** Copy operator. */
@@ -24,10 +24,13 @@
 #define xylose_nsort_NSort_h
 
 #include <xylose/nsort/map/direct.h>
+#include <xylose/nsort/map/block.h>
 #include <xylose/nsort/tweak/Null.h>
+#include <xylose/nsort/detail/scratch.h>
 #include <xylose/ref_of.h>
 
 #include <ostream>
+#include <iterator>
 #include <algorithm>
 
 namespace xylose {
@@ -36,7 +39,9 @@ namespace xylose {
   namespace nsort {
 
     /** An \f$ O(N) \f$ sort using a predefined number of sorting buckets.
-     * This is not necessarily a stable sort.
+     * The in-place sort(...) is not necessarily a stable sort.  The
+     * out-of-place stable_sort(...), stable_sort_copy(...), and the multi-pass
+     * radix_sort(...) (for very large numbers of buckets) are stable.
      * @tparam val_map
      *    Map a reference of the sorted items to an integer bucket index.  Note
      *    that this class does NOT check for overruns in the mapped value (to
@@ -45,30 +50,113 @@ namespace xylose {
      *
      * @tparam NSortTweaker
      *    Optional class to allow the user code to tweak the map according to
-     *    the preliminary counting statistics. <br>
+     *    the preliminary counting statistics.  tweakNSort(map, bin, n_values)
+     *    is given the count of each value in bin.  If it modifies the map, it
+     *    must also fold the counts in bin such that they are the counts of
+     *    the modified map (see tweak::traits and tweak::Balance). <br>
      *    [Default nsort::tweak::Null]
+     *
+     * The bucket tables are kept in a persistent workspace of
+     * 2*capacity() integers that is only reallocated when resize(...) asks
+     * for more buckets than the current capacity.  The workspace may also be
+     * provided by the caller (see the external-arena constructor).  Together
+     * with the pooled buffers of the stable sorts, repeated sorting does not
+     * perform any heap allocation once the workspace has grown to its
+     * steady-state size.
      */
     template < typename val_map = map::direct,
                typename NSortTweaker = tweak::Null >
     class NSort {
-    private:
+    protected:
       int n_values;
       int * bin;
 
+      /** Working starting positions used by the in-place sort. */
+      int * ptr;
+
+      /** Number of buckets that the workspace can hold. */
+      int n_capacity;
+
+      /** Whether the workspace is owned (and freed) by this instance. */
+      bool owns_workspace;
+
+      /** Cached bucket index of each item (used by the stable sorts). */
+      detail::scratch keys;
+
+      /** Pooled destination buffer (used by the stable sorts). */
+      detail::scratch pool;
+
+      /** Number of bits of the bucket index sorted per radix_sort pass. */
+      int digit_bits;
+
+      /** Per-digit histogram used by radix_sort. */
+      detail::scratch digits;
+
     public:
       /** Constructor allocates the specified number of buckets. */
-      NSort(const int & n_values) : n_values (n_values) {
-        bin = new int[n_values];
+      NSort(const int & n_values)
+        : n_values(0), bin(NULL), ptr(NULL),
+          n_capacity(0), owns_workspace(false), digit_bits(11) {
+        resize(n_values);
+      }
+
+      /** Constructor using an external arena for the bucket tables.
+       * The arena is not freed by this instance and must outlive it.
+       * @param n_values
+       *    The number of buckets.
+       * @param arena
+       *    Caller-provided memory for the bucket tables.
+       * @param arena_length
+       *    Number of integers in arena.  Up to arena_length/2 buckets can be
+       *    used before resize(...) falls back to an internally allocated
+       *    workspace.
+       */
+      NSort(const int & n_values, int * arena, const int & arena_length)
+        : n_values(0), bin(arena), ptr(arena + arena_length/2),
+          n_capacity(arena_length/2), owns_workspace(false), digit_bits(11) {
+        resize(n_values);
       }
 
       /** Destructor frees the buckets. */
       ~NSort() {
-        delete[] bin;
+        if (owns_workspace)
+          delete[] bin;
+      }
+
+      /** Change the number of buckets.  The workspace is only reallocated if
+       * the new number of buckets exceeds capacity().  The bucket table is
+       * reset to be empty until the next sort. */
+      void resize(const int & n) {
+        if (n > n_capacity) {
+          if (owns_workspace)
+            delete[] bin;
+          bin = new int[2*n];
+          ptr = bin + n;
+          n_capacity = n;
+          owns_workspace = true;
+        }
+        n_values = n;
+        std::fill(bin, bin + n_values, 0);
       }
 
+      /** Get the number of buckets that can be used without reallocation. */
+      inline const int & capacity() const { return n_capacity; }
+
       /** Get the number of bins/values used in this sort. */
       inline const int & size() const { return n_values; }
 
+      /** Get the maximum number of bits of the bucket index that radix_sort
+       * handles in each pass. */
+      inline const int & getDigitBits() const { return digit_bits; }
+
+      /** Set the maximum number of bits of the bucket index that radix_sort
+       * handles in each pass.  The per-pass histogram holds 2^bits integers
+       * and should fit comfortably in cache [Default 11].  Values less than
+       * one are clamped to one. */
+      inline void setDigitBits(const int & bits) {
+        digit_bits = std::max(1, bits);
+      }
+
       /** Obtain the index of the end() element of the ith value.
        * Note that i should conform to 0 <= i < n_values; there is no bound
        * checking on the input i.
@@ -109,15 +197,19 @@ namespace xylose {
       template <class Iter>
       void sort(const Iter & Ai, const Iter & Af,
                 val_map & map, NSortTweaker & nsortTweaker ) {
-        int * ptr = new int[n_values];
-
         using std::fill;
         fill(bin, bin + n_values, 0);
-        fill(ptr, ptr + n_values, 0);
 
-        /* first count the number of occurrences for each value. */
-        for (Iter i = Ai; i < Af; ++i)
-          ++bin[map(ref_of(*i))];
+        /* first count the number of occurrences for each value (mapping a
+         * block of items at a time). */
+        const int N = Af - Ai;
+        int key[nsort::map::detail::block_size];
+        for (int k0 = 0; k0 < N; k0 += nsort::map::detail::block_size) {
+          const int nb = std::min(nsort::map::detail::block_size, N - k0);
+          nsort::map::map_block(map, Ai + k0, nb, key);
+          for (int k = 0; k < nb; ++k)
+            ++bin[key[k]];
+        }
 
         /* Allow user code to tweak the map according to the preliminary
          * counting statistics. */
@@ -146,9 +238,382 @@ namespace xylose {
             std::iter_swap(Ai+pos, Ai + pos2++);
           }/*while*/
         }/*for*/
-
-        delete[] ptr;
       }/*sort()*/
+
+      /** Overload of stable_sort for using default constructed value map and
+       * tweaker.  This function subsequently calls the other overload of
+       * stable_sort().
+       */
+      template <class Iter>
+      void stable_sort(const Iter & Ai, const Iter & Af,
+                       const val_map & map = val_map(),
+                       const NSortTweaker & nsortTweaker = NSortTweaker()) {
+        val_map mapcopy = map;
+        NSortTweaker tweakcopy = nsortTweaker;
+        stable_sort(Ai,Af,mapcopy,tweakcopy);
+      }
+
+      /** Stable sort of the items within the range [Ai,Af) using the specified
+       * value map and NSort tweaker.
+       * The items are scattered into an internally pooled buffer (reused
+       * between calls) and then copied back into [Ai,Af).  The value map is
+       * only evaluated once per item.
+       */
+      template <class Iter>
+      void stable_sort(const Iter & Ai, const Iter & Af,
+                       val_map & map, NSortTweaker & nsortTweaker ) {
+        typedef typename std::iterator_traits<Iter>::value_type T;
+
+        const int N = Af - Ai;
+        const int * key = countKeys(Ai, Af, map, nsortTweaker);
+
+        T * dst = pool.template get<T>( N );
+        Iter it = Ai;
+        for (int k = 0; k < N; ++k, ++it)
+          new (dst + bin[key[k]]++) T(*it);
+
+        it = Ai;
+        for (int k = 0; k < N; ++k, ++it) {
+          *it = dst[k];
+          dst[k].~T();
+        }
+      }/*stable_sort()*/
+
+      /** Overload of stable_sort_copy for using default constructed value map
+       * and tweaker.  This function subsequently calls the other overload of
+       * stable_sort_copy().
+       */
+      template <class Iter, class OIter>
+      void stable_sort_copy(const Iter & Ai, const Iter & Af, const OIter & Oi,
+                            const val_map & map = val_map(),
+                            const NSortTweaker & nsortTweaker = NSortTweaker()) {
+        val_map mapcopy = map;
+        NSortTweaker tweakcopy = nsortTweaker;
+        stable_sort_copy(Ai,Af,Oi,mapcopy,tweakcopy);
+      }
+
+      /** Stable sort of the items within the range [Ai,Af) into the
+       * caller-provided range [Oi,Oi+(Af-Ai)) using the specified value map
+       * and NSort tweaker.  The input range is not modified and the value map
+       * is only evaluated once per item.
+       */
+      template <class Iter, class OIter>
+      void stable_sort_copy(const Iter & Ai, const Iter & Af, const OIter & Oi,
+                            val_map & map, NSortTweaker & nsortTweaker ) {
+        const int N = Af - Ai;
+        const int * key = countKeys(Ai, Af, map, nsortTweaker);
+
+        Iter it = Ai;
+        for (int k = 0; k < N; ++k, ++it)
+          *(Oi + bin[key[k]]++) = *it;
+      }/*stable_sort_copy()*/
+
+      /** Overload of sort_permutation for using default constructed value map
+       * and tweaker.  This function subsequently calls the other overload of
+       * sort_permutation().
+       */
+      template <class Iter, class PIter>
+      void sort_permutation(const Iter & Ai, const Iter & Af, const PIter & Pi,
+                            const val_map & map = val_map(),
+                            const NSortTweaker & nsortTweaker = NSortTweaker()) {
+        val_map mapcopy = map;
+        NSortTweaker tweakcopy = nsortTweaker;
+        sort_permutation(Ai,Af,Pi,mapcopy,tweakcopy);
+      }
+
+      /** Compute the permutation that stably sorts the items within the range
+       * [Ai,Af) without moving any of the items.  Upon return,
+       * <code>*(Pi+k)</code> is the index (relative to Ai) of the item that
+       * belongs at the kth sorted position and the bucket table is that of
+       * the sorted range.  This is useful for containers that store each
+       * member of the items in a separate array (see
+       * utility::soa_particles), since the permutation can then be applied
+       * to each array in turn.
+       */
+      template <class Iter, class PIter>
+      void sort_permutation(const Iter & Ai, const Iter & Af, const PIter & Pi,
+                            val_map & map, NSortTweaker & nsortTweaker ) {
+        const int N = Af - Ai;
+        const int * key = countKeys(Ai, Af, map, nsortTweaker);
+
+        for (int k = 0; k < N; ++k)
+          *(Pi + bin[key[k]]++) = k;
+      }/*sort_permutation()*/
+
+      /** Overload of radix_sort for using default constructed value map and
+       * tweaker.  This function subsequently calls the other overload of
+       * radix_sort().
+       */
+      template <class Iter>
+      void radix_sort(const Iter & Ai, const Iter & Af,
+                      const val_map & map = val_map(),
+                      const NSortTweaker & nsortTweaker = NSortTweaker()) {
+        val_map mapcopy = map;
+        NSortTweaker tweakcopy = nsortTweaker;
+        radix_sort(Ai,Af,mapcopy,tweakcopy);
+      }
+
+      /** Multi-pass (LSD radix) stable sort of the items within the range
+       * [Ai,Af) using the specified value map and NSort tweaker.
+       *
+       * For very large numbers of buckets, scattering directly to the final
+       * bucket (as in sort(...) and stable_sort(...)) is dominated by cache
+       * misses in the bucket table.  This sort instead splits the bucket index
+       * into digits of at most getDigitBits() bits and performs one stable
+       * scatter per digit, so that the histogram of each pass stays cache
+       * resident.  The items (together with their cached bucket index)
+       * alternate between [Ai,Af) and an internally pooled buffer.
+       *
+       * The resulting begin(i)/end(i) table is identical to that of
+       * sort(...).  The value map is only evaluated once per item.
+       */
+      template <class Iter>
+      void radix_sort(const Iter & Ai, const Iter & Af,
+                      val_map & map, NSortTweaker & nsortTweaker ) {
+        typedef typename std::iterator_traits<Iter>::value_type T;
+
+        const int N = Af - Ai;
+        int * key  = keys.template get<int>( 2*N );
+        int * key2 = key + N;
+
+        using std::fill;
+        fill(bin, bin + n_values, 0);
+
+        /* first count the number of occurrences for each value. */
+        nsort::map::map_block(map, Ai, N, key);
+        for (int k = 0; k < N; ++k)
+          ++bin[ key[k] ];
+
+        /* Allow user code to tweak the map according to the preliminary
+         * counting statistics. */
+        nsortTweaker.tweakNSort(map, bin, static_cast<const int&>(n_values));
+        if (tweak::traits<NSortTweaker>::modifies_map)
+          nsort::map::map_block(map, Ai, N, key);
+
+        /* the final table of end() positions is known from the full count. */
+        for (int i = 0, cur_ptr = 0; i < n_values; ++i) {
+          cur_ptr += bin[i];
+          bin[i]   = cur_ptr;
+        }
+
+        if (N == 0)
+          return;
+
+        /* split the bucket index into the fewest passes of (nearly) equal
+         * width. */
+        int total_bits = 0;
+        while ((n_values - 1) >> total_bits)
+          ++total_bits;
+        const int n_pass = std::max(1, (total_bits + digit_bits - 1) / digit_bits);
+        const int width  = (total_bits + n_pass - 1) / n_pass;
+        const int mask   = (1 << width) - 1;
+        int * count = digits.template get<int>( mask + 1 );
+
+        T * buf = pool.template get<T>( N );
+
+        /* The first pass constructs the items in the pooled buffer; the
+         * remaining passes alternate (by assignment) between the buffer and
+         * the original range. */
+        radixPass(Ai, key, buf, key2, N, 0, mask, count, true);
+        for (int p = 1; p < n_pass; ++p) {
+          if (p % 2)
+            radixPass(buf, key2, Ai, key, N, p*width, mask, count, false);
+          else
+            radixPass(Ai, key, buf, key2, N, p*width, mask, count, false);
+        }
+
+        if (n_pass % 2) {
+          Iter it = Ai;
+          for (int k = 0; k < N; ++k, ++it) {
+            *it = buf[k];
+            buf[k].~T();
+          }
+        } else {
+          for (int k = 0; k < N; ++k)
+            buf[k].~T();
+        }
+      }/*radix_sort()*/
+
+      /** Overload of resort for using a default constructed value map.
+       * This function subsequently calls the other overload of resort().
+       */
+      template <class Iter>
+      void resort(const Iter & Ai, const Iter & Af,
+                  const val_map & map = val_map()) {
+        val_map mapcopy = map;
+        resort(Ai,Af,mapcopy);
+      }
+
+      /** Incrementally re-sort the items within the range [Ai,Af) that were
+       * previously sorted by this instance (and possibly modified since).
+       *
+       * Only the items whose mapped value changed since the previous sort
+       * ("movers"), and the items that are displaced by the resulting shift
+       * of the bucket boundaries, are moved.  Each item is mapped once in a
+       * read-only scan to find the movers; all other work is proportional to
+       * the number of displaced items (plus the number of buckets to update
+       * the table).  For particles that only migrate between neighboring
+       * buckets, this is a small fraction of the work of sort(...).
+       *
+       * The NSort tweaker is not invoked.  If the current table does not
+       * describe a range of the same length (e.g. the first call or after
+       * resize(...)), this falls back to a full sort(...).  Like sort(...),
+       * this is not a stable sort.
+       */
+      template <class Iter>
+      void resort(const Iter & Ai, const Iter & Af, val_map & map) {
+        const int N = Af - Ai;
+        if (n_values == 0 || end(n_values-1) != N) {
+          NSortTweaker nsortTweaker;
+          sort(Ai, Af, map, nsortTweaker);
+          return;
+        }
+
+        int * movers = keys.template get<int>( 2*N );
+        int * bad = movers + N;
+        int n_movers = 0;
+
+        /* find the movers and the change in the population of each bucket. */
+        using std::fill;
+        fill(ptr, ptr + n_values, 0);
+        for (int i = 0, pos = 0; i < n_values; ++i) {
+          for (const int & end_pos = end(i); pos < end_pos; ++pos) {
+            const int k = map(ref_of(*(Ai + pos)));
+            if (k != i) {
+              movers[n_movers++] = pos;
+              --ptr[i];
+              ++ptr[k];
+            }
+          }
+        }
+
+        if (n_movers == 0)
+          return;
+
+        /* the new end() positions. */
+        for (int i = 0, shift = 0; i < n_values; ++i) {
+          shift += ptr[i];
+          ptr[i] = bin[i] + shift;
+        }
+
+        /* the displaced positions (in increasing order):  the movers and the
+         * items that are outside of the new range of their bucket. */
+        int n_bad = 0;
+        for (int i = 0, m = 0; i < n_values; ++i) {
+          const int obegin = begin(i), oend = end(i);
+          const int nbegin = (i == 0) ? 0 : ptr[i-1], nend = ptr[i];
+          const int lo = std::min(oend, nbegin);
+          const int hi = std::max(obegin, nend);
+
+          for (int pos = obegin; pos < lo; ++pos)
+            bad[n_bad++] = pos;
+          for (; m < n_movers && movers[m] < oend; ++m)
+            if (movers[m] >= lo && movers[m] < hi)
+              bad[n_bad++] = movers[m];
+          for (int pos = hi; pos < oend; ++pos)
+            bad[n_bad++] = pos;
+        }
+
+        /* bin[j] becomes the cursor to the first displaced position within
+         * the new range of the jth bucket. */
+        for (int j = 0, c = 0; j < n_values; ++j) {
+          bin[j] = c;
+          while (c < n_bad && bad[c] < ptr[j])
+            ++c;
+        }
+
+        /* permute the displaced items amongst the displaced positions. */
+        for (int j = 0; j < n_values; ++j) {
+          int & c = bin[j];
+          while (c < n_bad && bad[c] < ptr[j]) {
+            const int k = map(ref_of(*(Ai + bad[c])));
+            if (k == j) {
+              ++c;
+              continue;
+            }
+            std::iter_swap(Ai + bad[c], Ai + bad[bin[k]++]);
+          }
+        }
+
+        std::copy(ptr, ptr + n_values, bin);
+      }/*resort()*/
+
+    private:
+      /** Not copyable. */
+      NSort(const NSort &);
+      /** Not assignable. */
+      NSort & operator=(const NSort &);
+
+      /** Cache the bucket index of each item, count the occurrences of each
+       * value, and leave bin[i] as the starting position of the ith value.
+       * Scattering each item to bin[key]++ then leaves bin[i] as the end()
+       * position of the ith value. */
+      template <class Iter>
+      const int * countKeys(const Iter & Ai, const Iter & Af,
+                            val_map & map, NSortTweaker & nsortTweaker ) {
+        const int N = Af - Ai;
+        int * key = keys.template get<int>( N );
+
+        using std::fill;
+        fill(bin, bin + n_values, 0);
+
+        /* first count the number of occurrences for each value. */
+        nsort::map::map_block(map, Ai, N, key);
+        for (int k = 0; k < N; ++k)
+          ++bin[ key[k] ];
+
+        /* Allow user code to tweak the map according to the preliminary
+         * counting statistics.  The cached values are stale if the map was
+         * modified. */
+        nsortTweaker.tweakNSort(map, bin, static_cast<const int&>(n_values));
+        if (tweak::traits<NSortTweaker>::modifies_map)
+          nsort::map::map_block(map, Ai, N, key);
+
+        /* now change this array of occurrences to an array of start
+         * positions. */
+        for (int i = 0, cur_ptr = 0; i < n_values; ++i) {
+          const int count = bin[i];
+          bin[i]   = cur_ptr;
+          cur_ptr += count;
+        }
+
+        return key;
+      }
+
+      /** A single stable scatter of radix_sort according to the digit
+       * <code>(key >> shift) & mask</code>.
+       * @param construct
+       *    If true, the destination is raw memory and the items are copy
+       *    constructed instead of assigned.
+       */
+      template <class SrcIter, class DstIter>
+      void radixPass(const SrcIter & src, const int * skey,
+                     const DstIter & dst, int * dkey,
+                     const int & N, const int & shift, const int & mask,
+                     int * count, const bool & construct) {
+        typedef typename std::iterator_traits<DstIter>::value_type T;
+
+        using std::fill;
+        fill(count, count + mask + 1, 0);
+        for (int k = 0; k < N; ++k)
+          ++count[ (skey[k] >> shift) & mask ];
+
+        for (int i = 0, cur_ptr = 0; i <= mask; ++i) {
+          const int c = count[i];
+          count[i] = cur_ptr;
+          cur_ptr += c;
+        }
+
+        SrcIter it = src;
+        for (int k = 0; k < N; ++k, ++it) {
+          const int pos = count[ (skey[k] >> shift) & mask ]++;
+          if (construct)
+            new (&*(dst + pos)) T(*it);
+          else
+            *(dst + pos) = *it;
+          dkey[pos] = skey[k];
+        }
+      }
     };/* NSort class */
 
   }/* namespace nsort */
@@ -0,0 +1,329 @@
+/*==============================================================================
+ * Public Domain Contributions 2010 United States Government                   *
+ * as represented by the U.S. Air Force Research Laboratory.                   *
+ *                                                                             *
+ * This file is part of xylose                                                 *
+ *                                                                             *
+ * This program is free software: you can redistribute it and/or modify it     *
+ * under the terms of the GNU Lesser General Public License as published by    *
+ * the Free Software Foundation, either version 3 of the License, or (at your  *
+ * option) any later version.                                                  *
+ *                                                                             *
+ * This program is distributed in the hope that it will be useful, but WITHOUT *
+ * ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or       *
+ * FITNESS FOR A PARTICULAR PURPOSE.  See the GNU Lesser General Public        *
+ * License for more details.                                                   *
+ *                                                                             *
+ * You should have received a copy of the GNU Lesser General Public License    *
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.       *
+ *                                                                             *
+ -----------------------------------------------------------------------------*/
+
+
+
+#ifndef xylose_nsort_PNSort_h
+#define xylose_nsort_PNSort_h
+
+#include <xylose/nsort/NSort.h>
+#include <xylose/PThreadEval.h>
+#include <xylose/ref_of.h>
+
+#include <vector>
+#include <iterator>
+#include <algorithm>
+
+namespace xylose {
+  namespace nsort {
+
+    /** Multi-threaded \f$ O(N) \f$ sort using a predefined number of sorting
+     * buckets.
+     * The range [Ai,Af) is split into one contiguous chunk per thread of the
+     * PThreadCache.  Each thread counts its chunk into a local histogram, the
+     * histograms are combined by a parallel exclusive scan into per-thread
+     * bucket offsets, and each thread then scatters its chunk into a pooled
+     * buffer which is finally copied back into [Ai,Af) in parallel.  Because
+     * the chunks are scattered in order, this sort <b>is</b> stable.
+     *
+     * The bucket table (begin(i), end(i), size(i)) as well as the val_map and
+     * NSortTweaker hooks are exactly those of NSort.  The tweaker is given
+     * the combined counts of all threads (if it modifies the map, the chunks
+     * are counted again).  If the PThreadCache only has one thread, or if the
+     * range is too small to be worth splitting, the serial (in-place)
+     * NSort::sort is used instead.
+     *
+     * @tparam val_map
+     *    Map a reference of the sorted items to an integer bucket index. <br>
+     *    [Default nsort::map::direct]
+     *
+     * @tparam NSortTweaker
+     *    Optional class to allow the user code to tweak the map according to
+     *    the preliminary counting statistics. <br>
+     *    [Default nsort::tweak::Null]
+     *
+     * @see NSort.
+     */
+    template < typename val_map = map::direct,
+               typename NSortTweaker = tweak::Null >
+    class PNSort : public NSort<val_map,NSortTweaker> {
+      /* TYPEDEFS */
+    private:
+      typedef NSort<val_map,NSortTweaker> super;
+
+      /** Count the items of one chunk into the chunk's histogram. */
+      template < typename Iter >
+      struct CountTask : DefaultPThreadFunctor {
+        Iter i, f;
+        const val_map * map;
+        int * hist;
+
+        CountTask( const Iter & i, const Iter & f,
+                   const val_map * map, int * hist )
+          : i(i), f(f), map(map), hist(hist) { }
+
+        void operator() () {
+          const int N = f - i;
+          int key[nsort::map::detail::block_size];
+          for ( int k0 = 0; k0 < N; k0 += nsort::map::detail::block_size ) {
+            const int nb = std::min( nsort::map::detail::block_size, N - k0 );
+            nsort::map::map_block( *map, i + k0, nb, key );
+            for ( int k = 0; k < nb; ++k )
+              ++hist[ key[k] ];
+          }
+        }
+      };
+
+      /** Exclusive scan over the histograms of all chunks for a range of
+       * buckets.  The scan is performed in two phases:  the first phase sums
+       * the counts of each bucket (storing the sums in bin) and the total of
+       * the bucket range; the second phase converts each chunk's counts into
+       * starting positions, offset by the total of all preceding bucket
+       * ranges, and stores the end position of each bucket in bin. */
+      struct ScanTask : DefaultPThreadFunctor {
+        int b0, b1, n_values, n_chunks;
+        int * hist;
+        int * bin;
+        int * total;
+        int base;
+        bool reduce;
+
+        ScanTask( const int & b0, const int & b1,
+                  const int & n_values, const int & n_chunks,
+                  int * hist, int * bin, int * total,
+                  const int & base, const bool & reduce )
+          : b0(b0), b1(b1), n_values(n_values), n_chunks(n_chunks),
+            hist(hist), bin(bin), total(total), base(base), reduce(reduce) { }
+
+        void operator() () {
+          if ( reduce ) {
+            int sum = 0;
+            for ( int b = b0; b < b1; ++b ) {
+              int count = 0;
+              for ( int t = 0; t < n_chunks; ++t )
+                count += hist[t*n_values + b];
+              bin[b] = count;
+              sum += count;
+            }
+            *total = sum;
+          } else {
+            int cur_ptr = base;
+            for ( int b = b0; b < b1; ++b ) {
+              for ( int t = 0; t < n_chunks; ++t ) {
+                int & h = hist[t*n_values + b];
+                const int count = h;
+                h = cur_ptr;
+                cur_ptr += count;
+              }
+              bin[b] = cur_ptr;
+            }
+          }
+        }
+      };
+
+      /** Scatter the items of one chunk into the pooled buffer, using the
+       * chunk's starting positions. */
+      template < typename Iter, typename T >
+      struct ScatterTask : DefaultPThreadFunctor {
+        Iter i, f;
+        const val_map * map;
+        int * ptr;
+        T * dst;
+
+        ScatterTask( const Iter & i, const Iter & f,
+                     const val_map * map, int * ptr, T * dst )
+          : i(i), f(f), map(map), ptr(ptr), dst(dst) { }
+
+        void operator() () {
+          for ( Iter it = i; it < f; ++it )
+            new ( dst + ptr[ (*map)(ref_of(*it)) ]++ ) T(*it);
+        }
+      };
+
+      /** Copy a chunk of the pooled buffer back into the original range. */
+      template < typename Iter, typename T >
+      struct CopyBackTask : DefaultPThreadFunctor {
+        Iter i;
+        T * src;
+        int n;
+
+        CopyBackTask( const Iter & i, T * src, const int & n )
+          : i(i), src(src), n(n) { }
+
+        void operator() () {
+          Iter it = i;
+          for ( int k = 0; k < n; ++k, ++it ) {
+            *it = src[k];
+            src[k].~T();
+          }
+        }
+      };
+
+
+      /* MEMBER STORAGE */
+    private:
+      /** The thread cache used to execute the sort. */
+      PThreadCache & cache;
+
+      /** Per-chunk histograms (and then per-chunk starting positions). */
+      std::vector<int> hist;
+
+      /** Scan totals of each bucket range. */
+      std::vector<int> totals;
+
+
+      /* STATIC STORAGE */
+    public:
+      /** The minimum number of items that a thread will be given to sort.  */
+      static const int min_chunk_size = 4096;
+
+
+      /* MEMBER FUNCTIONS */
+    public:
+      /** Constructor allocates the specified number of buckets.
+       * @param n_values
+       *    The number of buckets.
+       * @param cache
+       *    Specify the cache instance to use [default xylose::pthreadCache].
+       */
+      PNSort( const int & n_values,
+              PThreadCache & cache = xylose::pthreadCache )
+        : super(n_values), cache(cache) { }
+
+      /** Overload of sort for using default constructed value map and tweaker.
+       * This function subsequently calls the other overload of sort().
+       */
+      template <class Iter>
+      void sort(const Iter & Ai, const Iter & Af,
+                const val_map & map = val_map(),
+                const NSortTweaker & nsortTweaker = NSortTweaker()) {
+        val_map mapcopy = map;
+        NSortTweaker tweakcopy = nsortTweaker;
+        sort(Ai,Af,mapcopy,tweakcopy);
+      }
+
+      /** Sort the items within the range [Ai,Af) using the specified value map
+       * and NSort tweaker. */
+      template <class Iter>
+      void sort(const Iter & Ai, const Iter & Af,
+                val_map & map, NSortTweaker & nsortTweaker ) {
+        typedef typename std::iterator_traits<Iter>::value_type T;
+
+        const int N = Af - Ai;
+        const int n_values = this->n_values;
+        int * const bin = this->bin;
+
+        const int n_chunks = std::min( cache.get_max_threads(),
+                                       N / min_chunk_size );
+        if ( n_chunks <= 1 ) {
+          super::sort(Ai, Af, map, nsortTweaker);
+          return;
+        }
+
+        const int chunk = (N + n_chunks - 1) / n_chunks;
+        const int b_chunk = (n_values + n_chunks - 1) / n_chunks;
+
+        hist.assign( n_chunks * n_values, 0 );
+        totals.assign( n_chunks, 0 );
+
+        /* first count the number of occurrences for each value in each chunk
+         * and combine the counts of all chunks. */
+        count( Ai, N, n_chunks, chunk, map );
+        scan( n_chunks, b_chunk, true );
+
+        /* Allow user code to tweak the map according to the preliminary
+         * counting statistics.  If the map was modified, the per-chunk counts
+         * are stale and must be recounted. */
+        nsortTweaker.tweakNSort(map, bin, static_cast<const int&>(n_values));
+        if ( tweak::traits<NSortTweaker>::modifies_map ) {
+          hist.assign( n_chunks * n_values, 0 );
+          count( Ai, N, n_chunks, chunk, map );
+          scan( n_chunks, b_chunk, true );
+        }
+
+        /* now change the arrays of occurrences to arrays of start positions.
+         * */
+        for ( int j = 0, cur_ptr = 0; j < n_chunks; ++j ) {
+          const int count = totals[j];
+          totals[j] = cur_ptr;
+          cur_ptr += count;
+        }
+        scan( n_chunks, b_chunk, false );
+
+        /* scatter each of the chunks into the pooled buffer. */
+        T * dst = this->pool.template get<T>( N );
+        {
+          PThreadEval< ScatterTask<Iter,T> > eval(cache);
+          for ( int t = 0; t < n_chunks; ++t ) {
+            const int lo = std::min( t * chunk, N );
+            const int hi = std::min( lo + chunk, N );
+            eval.eval( ScatterTask<Iter,T>( Ai + lo, Ai + hi, &map,
+                                            &hist[t*n_values], dst ) );
+          }
+          eval.joinAll();
+        }
+
+        /* copy the sorted items back into the original range. */
+        {
+          PThreadEval< CopyBackTask<Iter,T> > eval(cache);
+          for ( int t = 0; t < n_chunks; ++t ) {
+            const int lo = std::min( t * chunk, N );
+            const int hi = std::min( lo + chunk, N );
+            eval.eval( CopyBackTask<Iter,T>( Ai + lo, dst + lo, hi - lo ) );
+          }
+          eval.joinAll();
+        }
+      }/*sort()*/
+
+    private:
+      /** Count the occurrences of each value in each chunk. */
+      template < typename Iter >
+      void count( const Iter & Ai, const int & N, const int & n_chunks,
+                  const int & chunk, const val_map & map ) {
+        PThreadEval< CountTask<Iter> > eval(cache);
+        for ( int t = 0; t < n_chunks; ++t ) {
+          const int lo = std::min( t * chunk, N );
+          const int hi = std::min( lo + chunk, N );
+          eval.eval( CountTask<Iter>( Ai + lo, Ai + hi,
+                                      &map, &hist[t*this->n_values] ) );
+        }
+        eval.joinAll();
+      }
+
+      /** Execute one phase of the exclusive scan over all bucket ranges. */
+      void scan( const int & n_chunks, const int & b_chunk,
+                 const bool & reduce ) {
+        PThreadEval< ScanTask > eval(cache);
+        for ( int j = 0; j < n_chunks; ++j ) {
+          const int b0 = std::min( j * b_chunk, this->n_values );
+          const int b1 = std::min( b0 + b_chunk, this->n_values );
+          eval.eval( ScanTask( b0, b1, this->n_values, n_chunks,
+                               &hist[0], this->bin, &totals[j],
+                               totals[j], reduce ) );
+        }
+        eval.joinAll();
+      }
+    };/* PNSort class */
+
+  }/* namespace nsort */
+}/* namespace xylose */
+
+#endif // xylose_nsort_PNSort_h
@@ -0,0 +1,329 @@
+/*==============================================================================
+ * Public Domain Contributions 2010 United States Government                   *
+ * as represented by the U.S. Air Force Research Laboratory.                   *
+ *                                                                             *
+ * This file is part of xylose                                                 *
+ *                                                                             *
+ * This program is free software: you can redistribute it and/or modify it     *
+ * under the terms of the GNU Lesser General Public License as published by    *
+ * the Free Software Foundation, either version 3 of the License, or (at your  *
+ * option) any later version.                                                  *
+ *                                                                             *
+ * This program is distributed in the hope that it will be useful, but WITHOUT *
+ * ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or       *
+ * FITNESS FOR A PARTICULAR PURPOSE.  See the GNU Lesser General Public        *
+ * License for more details.                                                   *
+ *                                                                             *
+ * You should have received a copy of the GNU Lesser General Public License    *
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.       *
+ *                                                                             *
+ -----------------------------------------------------------------------------*/
+
+
+
+
+#ifndef xylose_nsort_PivotTree_h
+#define xylose_nsort_PivotTree_h
+
+#include <xylose/nsort/NSort.h>
+#include <xylose/nsort/PNSort.h>
+#include <xylose/nsort/map/pivot.h>
+#include <xylose/PThreadEval.h>
+#include <xylose/Dimensions.hpp>
+#include <xylose/Vector.h>
+#include <xylose/ref_of.h>
+
+#include <vector>
+#include <algorithm>
+
+namespace xylose {
+  namespace nsort {
+
+    /** A node of the flat node array of PivotTree. */
+    struct PivotTreeNode {
+      /** The pivot used to split this node (only used for interior nodes). */
+      Vector<double,3> pivot;
+
+      /** The items of this node are [begin,end) of the sorted range. */
+      int begin, end;
+
+      /** Index of the first of the (contiguous) children of this node in the
+       * node array; -1 for leaf nodes. */
+      int first_child;
+
+      /** Depth of this node (the root has depth 0). */
+      int depth;
+
+      /** Whether this node is a leaf. */
+      bool isLeaf() const { return first_child < 0; }
+
+      /** Number of items in this node. */
+      int size() const { return end - begin; }
+    };
+
+
+    /** Adaptive 2^n-tree (binary tree, quadtree or octree) built by
+     * recursively sorting a range of items with the nsort::map::pivot map.
+     *
+     * Each node is split around a pivot (the centroid or the per-direction
+     * median of its items) into the 2^ndims children of the pivot map, until
+     * a node holds no more than the leaf size (or the maximum depth is
+     * reached).  The items are left sorted such that every node corresponds
+     * to a contiguous range of items.
+     *
+     * The upper levels of the tree are sorted with PNSort.  Once nodes are
+     * small enough to provide enough independent work, each remaining
+     * subtree is built serially in a separate task on the PThreadCache and
+     * the subtrees are spliced into one flat node array.  The root is node
+     * 0 and the children of each interior node are contiguous.
+     *
+     * @tparam dims
+     *    The dimensions to split (see nsort::map::pivot). <br>
+     *    [Default Dimensions<0,1,2>]
+     */
+    template < typename dims = Dimensions<0u,1u,2u> >
+    class PivotTree {
+      /* TYPEDEFS */
+    public:
+      typedef PivotTreeNode Node;
+      typedef map::pivot<dims> pivot_map;
+
+      /** How the pivot of each node is chosen. */
+      enum PivotChoice {
+        /** The mean position of the items of the node. */
+        CENTROID,
+        /** The median position (in each direction) of the items of the
+         * node. */
+        MEDIAN
+      };
+
+      /** Number of children of each interior node. */
+      static const int n_children = pivot_map::number_values;
+
+    private:
+      /** Recursively splits nodes of a node array. */
+      template < typename Iter, typename Sorter >
+      struct Builder {
+        const PivotTree & tree;
+        Iter Ai;
+        Sorter & s;
+        std::vector<Node> & out;
+        std::vector<double> coord;
+
+        /** Nodes no larger than this are deferred to pending instead of being
+         * split (only if pending is not NULL). */
+        int task_size;
+        std::vector<int> * pending;
+
+        Builder( const PivotTree & tree, const Iter & Ai, Sorter & s,
+                 std::vector<Node> & out,
+                 const int & task_size = 0,
+                 std::vector<int> * pending = NULL )
+          : tree(tree), Ai(Ai), s(s), out(out),
+            task_size(task_size), pending(pending) { }
+
+        /** Split the node out[self] (and recursively its children). */
+        void expand( const int & self ) {
+          const Node n = out[self];
+          if ( n.size() <= tree.leaf_size || n.depth >= tree.max_depth )
+            return;
+
+          if ( pending && n.size() <= task_size ) {
+            pending->push_back( self );
+            return;
+          }
+
+          const Vector<double,3> p = choosePivot( n.begin, n.end );
+          s.sort( Ai + n.begin, Ai + n.end, pivot_map( p ) );
+
+          /* don't split a node whose items all fall on the same side of
+           * the pivot (e.g. coincident items). */
+          for ( int i = 0; i < n_children; ++i )
+            if ( s.size(i) == n.size() )
+              return;
+
+          const int first = out.size();
+          out[self].pivot = p;
+          out[self].first_child = first;
+          for ( int i = 0; i < n_children; ++i ) {
+            Node c;
+            c.pivot = p;
+            c.begin = n.begin + s.begin(i);
+            c.end   = n.begin + s.end(i);
+            c.first_child = -1;
+            c.depth = n.depth + 1;
+            out.push_back( c );
+          }
+
+          for ( int i = 0; i < n_children; ++i )
+            expand( first + i );
+        }
+
+        Vector<double,3> choosePivot( const int & b, const int & e ) {
+          Vector<double,3> p(0.0);
+          if ( tree.choice == CENTROID ) {
+            for ( Iter it = Ai + b, f = Ai + e; it < f; ++it )
+              p += position( ref_of(*it) );
+            p /= static_cast<double>( e - b );
+          } else {
+            const int mid = (e - b) / 2;
+            coord.resize( e - b );
+            for ( unsigned int d = 0; d < 3u; ++d ) {
+              Iter it = Ai + b;
+              for ( int k = 0; k < e - b; ++k, ++it )
+                coord[k] = position( ref_of(*it) )[d];
+              std::nth_element( coord.begin(), coord.begin() + mid,
+                                coord.end() );
+              p[d] = coord[mid];
+            }
+          }
+          return p;
+        }
+      };
+
+      /** Builds one subtree (rooted at a copy of root) serially. */
+      template < typename Iter >
+      struct SubtreeTask : DefaultPThreadFunctor {
+        const PivotTree * tree;
+        Iter Ai;
+        Node root;
+        std::vector<Node> * out;
+
+        SubtreeTask( const PivotTree * tree, const Iter & Ai,
+                     const Node & root, std::vector<Node> * out )
+          : tree(tree), Ai(Ai), root(root), out(out) { }
+
+        void operator() () {
+          NSort<pivot_map> s( n_children );
+          out->assign( 1u, root );
+          Builder< Iter, NSort<pivot_map> > b( *tree, Ai, s, *out );
+          b.expand( 0 );
+        }
+      };
+
+
+      /* MEMBER STORAGE */
+      /** The flat array of nodes. */
+      std::vector<Node> nodes;
+
+      /** Nodes with no more items than this are not split. */
+      int leaf_size;
+
+      /** Nodes at this depth are not split. */
+      int max_depth;
+
+      /** How to choose the pivot of each node. */
+      PivotChoice choice;
+
+      /** The cache manager to use. */
+      PThreadCache & cache;
+
+      /** Minimum number of items of a subtree that is built in its own task.
+       * */
+      static const int min_task_size = 4096;
+
+
+      /* MEMBER FUNCTIONS */
+    public:
+      /** Constructor.
+       * @param leaf_size
+       *    Nodes with no more than leaf_size items are not split
+       *    [default 16].
+       * @param choice
+       *    How to choose the pivot of each node [default CENTROID].
+       * @param max_depth
+       *    Maximum depth of the tree [default 32].
+       * @param cache
+       *    Specify the cache instance to use [default xylose::pthreadCache].
+       */
+      PivotTree( const int & leaf_size = 16,
+                 const PivotChoice & choice = CENTROID,
+                 const int & max_depth = 32,
+                 PThreadCache & cache = xylose::pthreadCache )
+        : leaf_size(leaf_size), max_depth(max_depth),
+          choice(choice), cache(cache) { }
+
+      /** Sort the items within the range [Ai,Af) into a new tree. */
+      template < typename Iter >
+      void build( const Iter & Ai, const Iter & Af ) {
+        const int N = Af - Ai;
+        nodes.clear();
+
+        Node root;
+        root.pivot = 0.0;
+        root.begin = 0;
+        root.end = N;
+        root.first_child = -1;
+        root.depth = 0;
+        nodes.push_back( root );
+
+        /* split the top of the tree until there are enough independent
+         * subtrees for the threads. */
+        const int n_threads = cache.get_max_threads();
+        std::vector<int> pending;
+        {
+          PNSort<pivot_map> s( n_children, cache );
+          Builder< Iter, PNSort<pivot_map> >
+            b( *this, Ai, s, nodes,
+               std::max( min_task_size, N / (4 * std::max(n_threads,1)) ),
+               ( n_threads > 1 ? &pending : NULL ) );
+          b.expand( 0 );
+        }
+
+        if ( pending.empty() )
+          return;
+
+        /* build the remaining subtrees in parallel. */
+        std::vector< std::vector<Node> > sub( pending.size() );
+        {
+          PThreadEval< SubtreeTask<Iter> > eval(cache);
+          for ( unsigned int j = 0; j < pending.size(); ++j )
+            eval.eval( SubtreeTask<Iter>( this, Ai, nodes[pending[j]],
+                                          &sub[j] ) );
+          eval.joinAll();
+        }
+
+        /* splice the subtrees into the flat node array.  The subtree root
+         * replaces its pending node; its descendents are appended. */
+        for ( unsigned int j = 0; j < pending.size(); ++j ) {
+          const std::vector<Node> & L = sub[j];
+          const int offset = static_cast<int>(nodes.size()) - 1;
+
+          nodes[pending[j]] = L[0];
+          if ( L[0].first_child >= 0 )
+            nodes[pending[j]].first_child += offset;
+
+          for ( unsigned int i = 1; i < L.size(); ++i ) {
+            nodes.push_back( L[i] );
+            if ( L[i].first_child >= 0 )
+              nodes.back().first_child += offset;
+          }
+        }
+      }
+
+      /** The flat array of nodes (the root is node 0). */
+      const std::vector<Node> & getNodes() const { return nodes; }
+
+      /** Number of nodes in the tree. */
+      int size() const { return nodes.size(); }
+
+      /** Access the ith node. */
+      const Node & operator[] ( const int & i ) const { return nodes[i]; }
+
+      /** Get the maximum number of items in leaf nodes. */
+      const int & getLeafSize() const { return leaf_size; }
+
+      /** Get the maximum depth of the tree. */
+      const int & getMaxDepth() const { return max_depth; }
+    };
+
+    template < typename dims >
+    const int PivotTree<dims>::n_children;
+
+    template < typename dims >
+    const int PivotTree<dims>::min_task_size;
+
+  }/* namespace xylose::nsort */
+}/* namespace xylose */
+
+#endif // xylose_nsort_PivotTree_h
@@ -0,0 +1,83 @@
+/*==============================================================================
+ * Public Domain Contributions 2010 United States Government                   *
+ * as represented by the U.S. Air Force Research Laboratory.                   *
+ *                                                                             *
+ * This file is part of xylose                                                 *
+ *                                                                             *
+ * This program is free software: you can redistribute it and/or modify it     *
+ * under the terms of the GNU Lesser General Public License as published by    *
+ * the Free Software Foundation, either version 3 of the License, or (at your  *
+ * option) any later version.                                                  *
+ *                                                                             *
+ * This program is distributed in the hope that it will be useful, but WITHOUT *
+ * ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or       *
+ * FITNESS FOR A PARTICULAR PURPOSE.  See the GNU Lesser General Public        *
+ * License for more details.                                                   *
+ *                                                                             *
+ * You should have received a copy of the GNU Lesser General Public License    *
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.       *
+ *                                                                             *
+ -----------------------------------------------------------------------------*/
+
+
+
+#ifndef xylose_nsort_detail_scratch_h
+#define xylose_nsort_detail_scratch_h
+
+#include <new>
+#include <cstddef>
+
+namespace xylose {
+  namespace nsort {
+    namespace detail {
+
+      /** Grow-only block of raw (uninitialized) memory that is reused between
+       * sorts.  The block is only reallocated when a larger request is made
+       * than any previous request.  Users are responsible for constructing and
+       * destroying any objects placed in this memory.
+       */
+      class scratch {
+        /* MEMBER STORAGE */
+      private:
+        void * mem;
+        std::size_t n_bytes;
+
+
+        /* MEMBER FUNCTIONS */
+      public:
+        /** Constructor does not allocate anything. */
+        scratch() : mem(NULL), n_bytes(0) { }
+
+        /** Destructor frees the raw memory. */
+        ~scratch() {
+          ::operator delete(mem);
+        }
+
+        /** Get raw memory large enough for n items of type T. */
+        template < typename T >
+        T * get( const std::size_t & n ) {
+          if ( n * sizeof(T) > n_bytes ) {
+            ::operator delete(mem);
+            mem = NULL;
+            n_bytes = 0;
+            mem = ::operator new( n * sizeof(T) );
+            n_bytes = n * sizeof(T);
+          }
+          return static_cast<T*>(mem);
+        }
+
+        /** The number of bytes currently allocated. */
+        const std::size_t & capacity() const { return n_bytes; }
+
+      private:
+        /** Not copyable. */
+        scratch( const scratch & );
+        /** Not assignable. */
+        scratch & operator=( const scratch & );
+      };
+
+    }/* namespace xylose::nsort::detail */
+  }/* namespace xylose::nsort */
+}/* namespace xylose */
+
+#endif // xylose_nsort_detail_scratch_h
@@ -0,0 +1,186 @@
+/*==============================================================================
+ * Public Domain Contributions 2010 United States Government                   *
+ * as represented by the U.S. Air Force Research Laboratory.                   *
+ *                                                                             *
+ * This file is part of xylose                                                 *
+ *                                                                             *
+ * This program is free software: you can redistribute it and/or modify it     *
+ * under the terms of the GNU Lesser General Public License as published by    *
+ * the Free Software Foundation, either version 3 of the License, or (at your  *
+ * option) any later version.                                                  *
+ *                                                                             *
+ * This program is distributed in the hope that it will be useful, but WITHOUT *
+ * ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or       *
+ * FITNESS FOR A PARTICULAR PURPOSE.  See the GNU Lesser General Public        *
+ * License for more details.                                                   *
+ *                                                                             *
+ * You should have received a copy of the GNU Lesser General Public License    *
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.       *
+ *                                                                             *
+ -----------------------------------------------------------------------------*/
+
+
+
+#ifndef xylose_nsort_map_block_h
+#define xylose_nsort_map_block_h
+
+#include <xylose/nsort/map/uniform_grid.h>
+#include <xylose/nsort/map/w_species.h>
+#include <xylose/nsort/map/remap.h>
+#include <xylose/ref_of.h>
+
+#include <boost/mpl/has_xxx.hpp>
+
+#include <algorithm>
+
+namespace xylose {
+  namespace nsort {
+    namespace map {
+
+      namespace detail {
+        BOOST_MPL_HAS_XXX_TRAIT_NAMED_DEF(has_tag, tag, false)
+
+        /** Tag used for maps that do not provide a tag. */
+        struct no_tag {};
+
+        /** Obtain the tag of a map (or no_tag). */
+        template < typename Map, bool = has_tag<Map>::value >
+        struct tag_of {
+          typedef no_tag type;
+        };
+
+        template < typename Map >
+        struct tag_of<Map,true> {
+          typedef typename Map::tag type;
+        };
+
+        /** Number of positions gathered at a time for the batch maps. */
+        static const int block_size = 256;
+
+        /** Gather the positions of a particle into the structure of arrays
+         * used by the batch uniform_grid maps. */
+        template < typename dims >
+        struct gather;
+
+        template < unsigned int dir0 >
+        struct gather< Dimensions<dir0> > {
+          template < typename V >
+          static void apply( double (*x)[block_size], const int & k,
+                             const V & r ) {
+            x[dir0][k] = r[dir0];
+          }
+        };
+
+        template < unsigned int dir0, unsigned int dir1 >
+        struct gather< Dimensions<dir0,dir1> > {
+          template < typename V >
+          static void apply( double (*x)[block_size], const int & k,
+                             const V & r ) {
+            x[dir0][k] = r[dir0];
+            x[dir1][k] = r[dir1];
+          }
+        };
+
+        template < unsigned int dir0, unsigned int dir1, unsigned int dir2 >
+        struct gather< Dimensions<dir0,dir1,dir2> > {
+          template < typename V >
+          static void apply( double (*x)[block_size], const int & k,
+                             const V & r ) {
+            x[dir0][k] = r[dir0];
+            x[dir1][k] = r[dir1];
+            x[dir2][k] = r[dir2];
+          }
+        };
+
+        /** Generic block map:  one call of the map per item. */
+        template < typename Map, typename Iter, typename Tag >
+        inline void map_block( const Map & map, const Iter & Ai,
+                               const int & n, int * key, const Tag & ) {
+          Iter it = Ai;
+          for ( int k = 0; k < n; ++k, ++it )
+            key[k] = map(ref_of(*it));
+        }
+
+        /** Map the positions of n items with the batch operator() of a
+         * uniform_grid map:  positions are gathered into a structure of
+         * arrays, block_size at a time.
+         *
+         * This is looked up unqualified (with argument dependent lookup), so
+         * that containers that already store the positions as a structure of
+         * arrays can provide an overload for their iterators that passes the
+         * columns directly (see utility::soa_particles).
+         */
+        template < typename Map, typename Iter >
+        inline void map_positions( const Map & map, const Iter & Ai,
+                                   const int & n, int * key ) {
+          typedef typename Map::dimensions dims;
+          double x[3][block_size];
+          const double * const xp[3] = { x[0], x[1], x[2] };
+
+          Iter it = Ai;
+          for ( int k0 = 0; k0 < n; k0 += block_size ) {
+            const int nb = std::min( block_size, n - k0 );
+            for ( int k = 0; k < nb; ++k, ++it )
+              gather<dims>::apply( x, k, position(ref_of(*it)) );
+            map( xp, nb, key + k0 );
+          }
+        }
+
+        /** Block map for uniform_grid:  map_positions(...) feeds the batch
+         * operator(). */
+        template < typename Map, typename Iter, typename dims >
+        inline void map_block( const Map & map, const Iter & Ai,
+                               const int & n, int * key,
+                               const tag::uniform_grid<dims> & ) {
+          map_positions( map, Ai, n, key );
+        }
+
+        /** Block map for w_species:  block map the wrapped map and then
+         * add the species index. */
+        template < typename Map, typename Iter >
+        inline void map_block( const Map & map, const Iter & Ai,
+                               const int & n, int * key,
+                               const tag::w_species & ) {
+          typedef typename Map::super super;
+          const super & s = map;
+          map_block( s, Ai, n, key, typename tag_of<super>::type() );
+
+          const int n_species = map.n_species;
+          Iter it = Ai;
+          for ( int k = 0; k < n; ++k, ++it )
+            key[k] = n_species * key[k] + species(ref_of(*it));
+        }
+
+        /** Block map for remap:  block map the wrapped map and then look up
+         * the remapped value. */
+        template < typename Map, typename Iter, typename T >
+        inline void map_block( const Map & map, const Iter & Ai,
+                               const int & n, int * key,
+                               const tag::remap<T> & ) {
+          typedef typename Map::super super;
+          const super & s = map;
+          map_block( s, Ai, n, key, typename tag_of<super>::type() );
+
+          for ( int k = 0; k < n; ++k )
+            key[k] = map.m_remap[ key[k] ];
+        }
+      }/* namespace xylose::nsort::map::detail */
+
+      /** Map the n items starting at Ai to their bucket indices.
+       * This is equivalent to <code>key[k] = map(ref_of(*(Ai+k)))</code>,
+       * but dispatches on the tag of the map so that maps that provide a
+       * batch interface (such as uniform_grid, possibly wrapped by w_species
+       * and/or remap) are evaluated a block at a time.
+       */
+      template < typename Map, typename Iter >
+      inline void map_block( const Map & map, const Iter & Ai,
+                             const int & n, int * key ) {
+        detail::map_block( map, Ai, n, key,
+                           typename detail::tag_of<Map>::type() );
+      }
+
+    }/* namespace xylose::nsort::map */
+  }/* namespace xylose::nsort */
+}/* namespace xylose */
+
+#endif // xylose_nsort_map_block_h
@@ -0,0 +1,212 @@
+/*==============================================================================
+ * Public Domain Contributions 2010 United States Government                   *
+ * as represented by the U.S. Air Force Research Laboratory.                   *
+ *                                                                             *
+ * This file is part of xylose                                                 *
+ *                                                                             *
+ * This program is free software: you can redistribute it and/or modify it     *
+ * under the terms of the GNU Lesser General Public License as published by    *
+ * the Free Software Foundation, either version 3 of the License, or (at your  *
+ * option) any later version.                                                  *
+ *                                                                             *
+ * This program is distributed in the hope that it will be useful, but WITHOUT *
+ * ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or       *
+ * FITNESS FOR A PARTICULAR PURPOSE.  See the GNU Lesser General Public        *
+ * License for more details.                                                   *
+ *                                                                             *
+ * You should have received a copy of the GNU Lesser General Public License    *
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.       *
+ *                                                                             *
+ -----------------------------------------------------------------------------*/
+
+
+
+#ifndef xylose_nsort_map_detail_curve_h
+#define xylose_nsort_map_detail_curve_h
+
+#include <xylose/Dimensions.hpp>
+#include <xylose/nsort/map/uniform_grid.h>
+
+#include <boost/cstdint.hpp>
+#include <boost/shared_ptr.hpp>
+
+#include <vector>
+#include <utility>
+#include <algorithm>
+#include <cassert>
+
+namespace xylose {
+  namespace nsort {
+    namespace map {
+      namespace detail {
+
+        /** Integer type of the (uncompacted) curve index. */
+        typedef boost::uint64_t curve_index;
+
+        /** The number of bits required to represent the cell indices [0,n).
+         */
+        inline unsigned int curve_bits( const unsigned int & n ) {
+          unsigned int b = 0u;
+          while ( b < 32u && (static_cast<curve_index>(1u) << b) < n )
+            ++b;
+          return b;
+        }
+
+        /** Morton index of the point X (n dimensions, b[i] bits along the
+         * ith direction).  The bits are interleaved from the least
+         * significant bit upwards; directions run out of bits as they are
+         * exhausted so that no bits are wasted on the smaller directions.
+         */
+        inline curve_index morton_index( const unsigned int * X,
+                                         const unsigned int & n,
+                                         const unsigned int * b ) {
+          curve_index m = 0u;
+          unsigned int pos = 0u;
+          for ( unsigned int j = 0u; j < 32u; ++j )
+            for ( unsigned int i = 0u; i < n; ++i )
+              if ( j < b[i] )
+                m |= static_cast<curve_index>( (X[i] >> j) & 1u ) << pos++;
+          return m;
+        }
+
+        /** Hilbert index of the point X (n dimensions, b bits each).  This
+         * uses the transpose algorithm of J. Skilling, "Programming the
+         * Hilbert curve", AIP Conf. Proc. 707, 381 (2004).  X is modified.
+         */
+        inline curve_index hilbert_index( unsigned int * X,
+                                          const unsigned int & n,
+                                          const unsigned int & b ) {
+          if ( b == 0u )
+            return 0u;
+
+          const unsigned int M = 1u << (b - 1u);
+
+          /* inverse undo excess work. */
+          for ( unsigned int Q = M; Q > 1u; Q >>= 1 ) {
+            const unsigned int P = Q - 1u;
+            for ( unsigned int i = 0u; i < n; ++i ) {
+              if ( X[i] & Q )
+                X[0] ^= P;
+              else {
+                const unsigned int t = (X[0] ^ X[i]) & P;
+                X[0] ^= t;
+                X[i] ^= t;
+              }
+            }
+          }
+
+          /* gray encode. */
+          for ( unsigned int i = 1u; i < n; ++i )
+            X[i] ^= X[i-1];
+          unsigned int t = 0u;
+          for ( unsigned int Q = M; Q > 1u; Q >>= 1 )
+            if ( X[n-1] & Q )
+              t ^= Q - 1u;
+          for ( unsigned int i = 0u; i < n; ++i )
+            X[i] ^= t;
+
+          /* interleave the transposed bits into the index. */
+          curve_index h = 0u;
+          for ( int j = b - 1; j >= 0; --j )
+            for ( unsigned int i = 0u; i < n; ++i )
+              h = (h << 1) | ((X[i] >> j) & 1u);
+          return h;
+        }
+
+
+        /** The directions of a two or three dimensional Dimensions. */
+        template < typename dims >
+        struct directions;
+
+        template < unsigned int dir0, unsigned int dir1 >
+        struct directions< Dimensions<dir0,dir1> > {
+          static void get( unsigned int * dir ) {
+            dir[0] = dir0;
+            dir[1] = dir1;
+          }
+        };
+
+        template < unsigned int dir0, unsigned int dir1, unsigned int dir2 >
+        struct directions< Dimensions<dir0,dir1,dir2> > {
+          static void get( unsigned int * dir ) {
+            dir[0] = dir0;
+            dir[1] = dir1;
+            dir[2] = dir2;
+          }
+        };
+
+
+        /** Common implementation of the space-filling-curve maps.
+         *
+         * The cell of a particle is computed by the uniform_grid map (for
+         * the same dimensions) and then looked up in a rank table that gives
+         * the position of the cell along the curve.  The curve itself covers
+         * a power-of-two box, but only the cells of the actual grid are
+         * ranked, so that getNumberValues() equals the number of cells of the
+         * grid (there are no empty padding buckets).  The rank table holds
+         * one int per cell, is computed at construction and is shared by the
+         * copies of the map.
+         *
+         * @tparam Curve
+         *    Provides <code>static curve_index index(X, ndims, b)</code> for
+         *    the cell X (modifiable) with b[i] bits along the ith direction.
+         */
+        template < typename Uniform, typename dims, typename Curve >
+        struct curve_grid {
+          /** The row-major grid map. */
+          const uniform_grid< Uniform, dims > grid;
+
+          /** Position of each (row-major) grid cell along the curve. */
+          boost::shared_ptr< const std::vector<int> > rank;
+
+          curve_grid( const Uniform & g ) : grid( g ) {
+            build_rank();
+          }
+
+          int getNumberValues() const {
+            return static_cast<int>( rank->size() );
+          }
+
+          template < typename Particle >
+          int operator()( const Particle & p ) const {
+            return (*rank)[ grid(p) ];
+          }
+
+        private:
+          void build_rank() {
+            unsigned int dir[3];
+            directions<dims>::get( dir );
+            const unsigned int nd = dims::ndims;
+
+            unsigned int n[3], b[3];
+            for ( unsigned int i = 0u; i < nd; ++i ) {
+              n[i] = grid.g.size()[ dir[i] ];
+              b[i] = curve_bits( n[i] );
+            }
+
+            const int n_cells = grid.getNumberValues();
+            std::vector< std::pair<curve_index,int> > order( n_cells );
+            for ( int c = 0; c < n_cells; ++c ) {
+              /* the row-major layout of uniform_grid:  dir0 is fastest. */
+              unsigned int X[3];
+              for ( unsigned int i = 0u, r = c; i < nd; ++i ) {
+                X[i] = r % n[i];
+                r /= n[i];
+              }
+              order[c] = std::make_pair( Curve::index( X, nd, b ), c );
+            }
+            std::sort( order.begin(), order.end() );
+
+            std::vector<int> * r = new std::vector<int>( n_cells );
+            for ( int i = 0; i < n_cells; ++i )
+              (*r)[ order[i].second ] = i;
+            rank.reset( r );
+          }
+        };
+
+      }/* namespace xylose::nsort::map::detail */
+    }/* namespace xylose::nsort::map */
+  }/* namespace xylose::nsort */
+}/* namespace xylose */
+
+#endif // xylose_nsort_map_detail_curve_h
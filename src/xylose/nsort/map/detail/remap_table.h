@@ -0,0 +1,184 @@
+/*==============================================================================
+ * Public Domain Contributions 2010 United States Government                   *
+ * as represented by the U.S. Air Force Research Laboratory.                   *
+ *                                                                             *
+ * This file is part of xylose                                                 *
+ *                                                                             *
+ * This program is free software: you can redistribute it and/or modify it     *
+ * under the terms of the GNU Lesser General Public License as published by    *
+ * the Free Software Foundation, either version 3 of the License, or (at your  *
+ * option) any later version.                                                  *
+ *                                                                             *
+ * This program is distributed in the hope that it will be useful, but WITHOUT *
+ * ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or       *
+ * FITNESS FOR A PARTICULAR PURPOSE.  See the GNU Lesser General Public        *
+ * License for more details.                                                   *
+ *                                                                             *
+ * You should have received a copy of the GNU Lesser General Public License    *
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.       *
+ *                                                                             *
+ -----------------------------------------------------------------------------*/
+
+
+
+#ifndef xylose_nsort_map_detail_remap_table_h
+#define xylose_nsort_map_detail_remap_table_h
+
+#include <ostream>
+#include <cassert>
+
+namespace xylose {
+  namespace nsort {
+    namespace map {
+      namespace detail {
+
+        /** Fixed size table of remapped values in [0,N) that keeps track of
+         * the number of distinct values as entries are changed.
+         *
+         * Reading an entry of a const table yields the value directly.
+         * Writing an entry of a non-const table goes through a reference
+         * proxy that updates the number of occurrences of the old and new
+         * values, so that getNumberDistinct() is \f$ O(1) \f$.  The dense
+         * (compacted) index of the distinct values is rebuilt, without any
+         * allocation, on the first request after a change.
+         *
+         * The proxy supports assignment, compound addition/subtraction and
+         * increment/decrement.  Unlike a plain int array, the non-const table
+         * does not decay to an int pointer and its entries cannot be bound
+         * to an int reference; use data() for read-only access to the
+         * values as a contiguous array.
+         */
+        template < unsigned int N >
+        class remap_table {
+          /* MEMBER STORAGE */
+        private:
+          /** The remapped values. */
+          int values[N];
+
+          /** Number of entries that are mapped to each value. */
+          int occurrences[N];
+
+          /** Number of distinct values. */
+          unsigned int n_distinct;
+
+          /** Dense index of each distinct value (-1 for unused values). */
+          mutable int compact[N];
+
+          /** Whether compact must be rebuilt. */
+          mutable bool compact_dirty;
+
+
+          /* MEMBER FUNCTIONS */
+        public:
+          /** Proxy reference to an entry of the table. */
+          class reference {
+            remap_table & t;
+            const unsigned int i;
+          public:
+            reference( remap_table & t, const unsigned int & i )
+              : t(t), i(i) { }
+
+            operator int() const { return t.values[i]; }
+
+            reference & operator= ( const int & v ) {
+              t.set( i, v );
+              return *this;
+            }
+
+            reference & operator= ( const reference & that ) {
+              t.set( i, static_cast<int>(that) );
+              return *this;
+            }
+
+            reference & operator+= ( const int & d ) {
+              t.set( i, t.values[i] + d );
+              return *this;
+            }
+
+            reference & operator-= ( const int & d ) {
+              t.set( i, t.values[i] - d );
+              return *this;
+            }
+
+            reference & operator++ () { return *this += 1; }
+            reference & operator-- () { return *this -= 1; }
+
+            int operator++ (int) {
+              const int old = t.values[i];
+              *this += 1;
+              return old;
+            }
+
+            int operator-- (int) {
+              const int old = t.values[i];
+              *this -= 1;
+              return old;
+            }
+
+            friend std::ostream & operator<< ( std::ostream & out,
+                                               const reference & r ) {
+              return out << static_cast<int>(r);
+            }
+          };
+
+          /** Constructor initializes to the identity. */
+          remap_table() { reset(); }
+
+          /** Resets each value to the identity (0..N-1). */
+          void reset() {
+            for ( unsigned int i = 0; i < N; ++i ) {
+              values[i] = i;
+              occurrences[i] = 1;
+            }
+            n_distinct = N;
+            compact_dirty = true;
+          }
+
+          /** Set the ith entry to v (0 <= v < N). */
+          void set( const unsigned int & i, const int & v ) {
+            assert( 0 <= v && v < static_cast<int>(N) );
+            int & old = values[i];
+            if ( old == v )
+              return;
+
+            if ( --occurrences[old] == 0 )
+              --n_distinct;
+            if ( occurrences[v]++ == 0 )
+              ++n_distinct;
+            old = v;
+            compact_dirty = true;
+          }
+
+          const int & operator[] ( const unsigned int & i ) const {
+            return values[i];
+          }
+
+          reference operator[] ( const unsigned int & i ) {
+            return reference( *this, i );
+          }
+
+          /** The values as a contiguous (read-only) array. */
+          const int * data() const { return values; }
+
+          /** The number of distinct values in the table. */
+          const unsigned int & getNumberDistinct() const { return n_distinct; }
+
+          /** The dense index (0..getNumberDistinct()-1) of each value, in
+           * increasing order of the values.  Values that do not occur in the
+           * table have an index of -1. */
+          const int * getCompactIndex() const {
+            if ( compact_dirty ) {
+              for ( unsigned int v = 0, c = 0; v < N; ++v )
+                compact[v] = occurrences[v] ? static_cast<int>(c++) : -1;
+              compact_dirty = false;
+            }
+            return compact;
+          }
+        };
+
+      }/* namespace xylose::nsort::map::detail */
+    }/* namespace xylose::nsort::map */
+  }/* namespace xylose::nsort */
+}/* namespace xylose */
+
+#endif // xylose_nsort_map_detail_remap_table_h
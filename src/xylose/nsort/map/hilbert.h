@@ -0,0 +1,90 @@
+/*==============================================================================
+ * Public Domain Contributions 2010 United States Government                   *
+ * as represented by the U.S. Air Force Research Laboratory.                   *
+ *                                                                             *
+ * This file is part of xylose                                                 *
+ *                                                                             *
+ * This program is free software: you can redistribute it and/or modify it     *
+ * under the terms of the GNU Lesser General Public License as published by    *
+ * the Free Software Foundation, either version 3 of the License, or (at your  *
+ * option) any later version.                                                  *
+ *                                                                             *
+ * This program is distributed in the hope that it will be useful, but WITHOUT *
+ * ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or       *
+ * FITNESS FOR A PARTICULAR PURPOSE.  See the GNU Lesser General Public        *
+ * License for more details.                                                   *
+ *                                                                             *
+ * You should have received a copy of the GNU Lesser General Public License    *
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.       *
+ *                                                                             *
+ -----------------------------------------------------------------------------*/
+
+
+
+#ifndef xylose_nsort_map_hilbert_h
+#define xylose_nsort_map_hilbert_h
+
+#include <xylose/Dimensions.hpp>
+#include <xylose/nsort/map/detail/curve.h>
+
+#include <algorithm>
+#include <cassert>
+
+namespace xylose {
+  namespace nsort {
+    namespace map {
+      namespace tag {
+        /** Simple tag class that can be used to detect this map. */
+        template < typename dims >
+        struct hilbert {};
+      }
+
+      namespace detail {
+        /** Hilbert curve policy for curve_grid:  the curve covers a cube of
+         * 2^b cells per direction, where b is the largest number of bits of
+         * any direction. */
+        struct hilbert_curve {
+          static curve_index index( unsigned int * X,
+                                    const unsigned int & n,
+                                    const unsigned int * b ) {
+            return hilbert_index( X, n, *std::max_element( b, b + n ) );
+          }
+        };
+      }
+
+      /** Grid sorting map that orders the cells of the Uniform grid along a
+       * Hilbert curve.  For grids of 2^b cells in each direction,
+       * consecutive cells along the curve are always face neighbors, which
+       * gives somewhat better locality than the Morton curve.
+       *
+       * As for the morton map, only actual grid cells are ranked along the
+       * curve, so that getNumberValues() is the number of cells of the grid.
+       * Only two and three dimensional maps are supported.
+       * @see morton.
+       */
+      template < typename Uniform,
+                 typename dims = Dimensions<0u,1u,2u> >
+      struct hilbert
+        : detail::curve_grid< Uniform, dims, detail::hilbert_curve > {
+        typedef dims dimensions;
+        typedef map::tag::hilbert< dimensions > tag;
+        typedef void super;
+
+      private:
+        typedef detail::curve_grid< Uniform, dims, detail::hilbert_curve > base;
+      public:
+
+        hilbert( const Uniform & g ) : base( g ) {
+          assert( dims::ndims > 1u );
+        }
+
+        hilbert( const Uniform * g ) : base( *g ) {
+          assert( dims::ndims > 1u );
+        }
+      };
+
+    }/* namespace xylose::nsort::map */
+  }/* namespace xylose::nsort */
+}/* namespace xylose */
+
+#endif // xylose_nsort_map_hilbert_h
@@ -0,0 +1,92 @@
+/*==============================================================================
+ * Public Domain Contributions 2010 United States Government                   *
+ * as represented by the U.S. Air Force Research Laboratory.                   *
+ *                                                                             *
+ * This file is part of xylose                                                 *
+ *                                                                             *
+ * This program is free software: you can redistribute it and/or modify it     *
+ * under the terms of the GNU Lesser General Public License as published by    *
+ * the Free Software Foundation, either version 3 of the License, or (at your  *
+ * option) any later version.                                                  *
+ *                                                                             *
+ * This program is distributed in the hope that it will be useful, but WITHOUT *
+ * ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or       *
+ * FITNESS FOR A PARTICULAR PURPOSE.  See the GNU Lesser General Public        *
+ * License for more details.                                                   *
+ *                                                                             *
+ * You should have received a copy of the GNU Lesser General Public License    *
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.       *
+ *                                                                             *
+ -----------------------------------------------------------------------------*/
+
+
+
+#ifndef xylose_nsort_map_morton_h
+#define xylose_nsort_map_morton_h
+
+#include <xylose/Dimensions.hpp>
+#include <xylose/nsort/map/detail/curve.h>
+
+#include <cassert>
+
+namespace xylose {
+  namespace nsort {
+    namespace map {
+      namespace tag {
+        /** Simple tag class that can be used to detect this map. */
+        template < typename dims >
+        struct morton {};
+      }
+
+      namespace detail {
+        /** Morton curve policy for curve_grid. */
+        struct morton_curve {
+          static curve_index index( unsigned int * X,
+                                    const unsigned int & n,
+                                    const unsigned int * b ) {
+            return morton_index( X, n, b );
+          }
+        };
+      }
+
+      /** Grid sorting map that orders the cells of the Uniform grid along a
+       * Morton (Z-order) curve instead of row-major order.  Neighboring
+       * cells (in any direction) thereby tend to be close together in the
+       * sorted order.
+       *
+       * The cell is computed by uniform_grid and then ranked along the
+       * curve.  Each direction uses only as many bits as its own grid
+       * dimension requires and only actual grid cells are ranked, such that
+       * getNumberValues() is the number of cells of the grid (as for
+       * uniform_grid).  The rank table (one int per cell) is computed at
+       * construction, so the map should be re-created if the grid size
+       * changes.
+       *
+       * Only two and three dimensional maps are provided.
+       */
+      template < typename Uniform,
+                 typename dims = Dimensions<0u,1u,2u> >
+      struct morton
+        : detail::curve_grid< Uniform, dims, detail::morton_curve > {
+        typedef dims dimensions;
+        typedef map::tag::morton< dimensions > tag;
+        typedef void super;
+
+      private:
+        typedef detail::curve_grid< Uniform, dims, detail::morton_curve > base;
+      public:
+
+        morton( const Uniform & g ) : base( g ) {
+          assert( dims::ndims > 1u );
+        }
+
+        morton( const Uniform * g ) : base( *g ) {
+          assert( dims::ndims > 1u );
+        }
+      };
+
+    }/* namespace xylose::nsort::map */
+  }/* namespace xylose::nsort */
+}/* namespace xylose */
+
+#endif // xylose_nsort_map_morton_h
@@ -24,7 +24,7 @@
 #ifndef xylose_nsort_map_remap_h
 #define xylose_nsort_map_remap_h
 
-#include <set>
+#include <xylose/nsort/map/detail/remap_table.h>
 
 namespace xylose {
   namespace nsort {
@@ -39,6 +39,18 @@ namespace xylose {
        * An example use of this class is to remap a portion of the domain of the
        * underlying map function onto another portion of the map function's
        * domain.
+       *
+       * The entries of m_remap are read and written like the elements of an
+       * array of int (each value must be in [0,number_values)).  The table
+       * keeps track of the number of distinct values as entries are written,
+       * so that getNumberValues() is \f$ O(1) \f$.
+       *
+       * Note that m_remap used to be a plain <code>int[number_values]</code>.
+       * Element-wise access (=, +=, -=, ++, --) works as before, but the
+       * table no longer decays to an <code>int *</code> and its entries cannot
+       * be bound to an <code>int &</code>; code that did so must use
+       * m_remap.set(i,v) to write and m_remap.data() to read the values.
+       * @see static_remap for a remap table that is known at compile time.
        * */
       template < typename T,
                  unsigned int _nval = T::number_values >
@@ -52,8 +64,8 @@ namespace xylose {
         /* STORAGE MEMBER(S) */
 
         /** The remap map. */
-        int m_remap[number_values];
-      
+        detail::remap_table<number_values> m_remap;
+
 
         /* FUNCTION MEMBERS */
         /** Default constructor calls 'reset'.
@@ -73,18 +85,21 @@ namespace xylose {
 
         /** Resets the m_remap[] array to 1..nval. */
         void reset() {
-          for ( unsigned int i = 0; i < number_values; ++i )
-            m_remap[i] = i;
+          m_remap.reset();
         }
 
-        /** Returns the number of unique values.  This function cannot be
-         * optimized away during compilation because it relies on runtime
-         * calculations.
+        /** Returns the number of unique values.  This is maintained as the
+         * entries of m_remap are changed (no allocation or sorting).
          * */
         inline int getNumberValues() const {
-          /** \todo Is there a way to make this not rely on heap allocation? */
-          std::set<int> s( m_remap, m_remap + number_values );
-          return s.size();
+          return m_remap.getNumberDistinct();
+        }
+
+        /** Dense index (0..getNumberValues()-1) of each remapped value, or -1
+         * for values that are not used.
+         * @see detail::remap_table::getCompactIndex. */
+        inline const int * getCompactIndex() const {
+          return m_remap.getCompactIndex();
         }
 
         /** Actual remap operation used when performing sorting. */
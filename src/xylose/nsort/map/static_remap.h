@@ -0,0 +1,140 @@
+/*==============================================================================
+ * Public Domain Contributions 2010 United States Government                   *
+ * as represented by the U.S. Air Force Research Laboratory.                   *
+ *                                                                             *
+ * This file is part of xylose                                                 *
+ *                                                                             *
+ * This program is free software: you can redistribute it and/or modify it     *
+ * under the terms of the GNU Lesser General Public License as published by    *
+ * the Free Software Foundation, either version 3 of the License, or (at your  *
+ * option) any later version.                                                  *
+ *                                                                             *
+ * This program is distributed in the hope that it will be useful, but WITHOUT *
+ * ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or       *
+ * FITNESS FOR A PARTICULAR PURPOSE.  See the GNU Lesser General Public        *
+ * License for more details.                                                   *
+ *                                                                             *
+ * You should have received a copy of the GNU Lesser General Public License    *
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.       *
+ *                                                                             *
+ -----------------------------------------------------------------------------*/
+
+
+
+#ifndef xylose_nsort_map_static_remap_h
+#define xylose_nsort_map_static_remap_h
+
+#include <boost/mpl/size.hpp>
+#include <boost/mpl/fold.hpp>
+#include <boost/mpl/set.hpp>
+#include <boost/mpl/insert.hpp>
+#include <boost/mpl/placeholders.hpp>
+#include <boost/mpl/for_each.hpp>
+
+namespace xylose {
+  namespace nsort {
+    namespace map {
+      namespace tag {
+        template < typename T, typename Table >
+        struct static_remap {};
+      }
+
+      namespace detail {
+        /** The number of distinct values of an mpl sequence of integral
+         * constants. */
+        template < typename Table >
+        struct distinct_values {
+          typedef typename boost::mpl::fold<
+            Table,
+            boost::mpl::set0<>,
+            boost::mpl::insert< boost::mpl::_1, boost::mpl::_2 >
+          >::type set;
+
+          static const unsigned int value = boost::mpl::size<set>::value;
+        };
+      }
+
+      /** Re-maps an underlying map function onto a different set of mapped
+       * values according to a table that is known at compile time.
+       *
+       * The table is given as an mpl sequence of integral constants, for
+       * example <code>boost::mpl::vector_c<int, 0,0,1,1></code>.  Both the
+       * number of remapped values (number_values) and the number of distinct
+       * values (number_distinct, returned by getNumberValues()) are
+       * compile-time constants, so that sizing the sorter requires no runtime
+       * work at all.
+       * @see remap for a remap table that can be changed at runtime.
+       * */
+      template < typename T, typename Table >
+      struct static_remap : T {
+        typedef map::tag::static_remap<T,Table> tag;
+        typedef T super;
+
+        /** Number of possible values of the underlying map. */
+        static const unsigned int number_values =
+          boost::mpl::size<Table>::value;
+
+        /** Number of distinct remapped values. */
+        static const unsigned int number_distinct =
+          detail::distinct_values<Table>::value;
+
+      private:
+        /** Read-only table of the remapped values (filled from Table). */
+        class table_type {
+          int values[number_values];
+
+          /** Copies each value of the table. */
+          struct assign {
+            int * & dst;
+            assign( int * & dst ) : dst(dst) { }
+
+            template < typename C >
+            void operator() ( const C & ) { *dst++ = C::value; }
+          };
+
+        public:
+          table_type() {
+            int * dst = values;
+            boost::mpl::for_each<Table>( assign(dst) );
+          }
+
+          const int & operator[] ( const unsigned int & i ) const {
+            return values[i];
+          }
+
+          operator const int * () const { return values; }
+        };
+
+      public:
+        /* STORAGE MEMBER(S) */
+
+        /** The remap map (filled from Table).  The entries can only be read,
+         * since the table is fixed by the Table type. */
+        table_type m_remap;
+
+
+        /* FUNCTION MEMBERS */
+        /** Default constructor. */
+        static_remap() : super() { }
+
+        /** Constructor passes to super as required by wrapping components. */
+        template <class TT>
+        static_remap(const TT & tt) : super(tt) { }
+
+        /** Returns the (compile time) number of unique values. */
+        inline int getNumberValues() const {
+          return number_distinct;
+        }
+
+        /** Actual remap operation used when performing sorting. */
+        template < typename Particle >
+        inline int operator()(const Particle & p) const {
+          return m_remap[super::operator()(p)];
+        }
+      };
+
+    }
+  }
+}
+
+#endif // xylose_nsort_map_static_remap_h
@@ -0,0 +1,122 @@
+/*==============================================================================
+ * Public Domain Contributions 2010 United States Government                   *
+ * as represented by the U.S. Air Force Research Laboratory.                   *
+ *                                                                             *
+ * This file is part of xylose                                                 *
+ *                                                                             *
+ * This program is free software: you can redistribute it and/or modify it     *
+ * under the terms of the GNU Lesser General Public License as published by    *
+ * the Free Software Foundation, either version 3 of the License, or (at your  *
+ * option) any later version.                                                  *
+ *                                                                             *
+ * This program is distributed in the hope that it will be useful, but WITHOUT *
+ * ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or       *
+ * FITNESS FOR A PARTICULAR PURPOSE.  See the GNU Lesser General Public        *
+ * License for more details.                                                   *
+ *                                                                             *
+ * You should have received a copy of the GNU Lesser General Public License    *
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.       *
+ *                                                                             *
+ -----------------------------------------------------------------------------*/
+
+
+
+#include <xylose/nsort/map/block.h>
+#include <xylose/nsort/map/uniform_grid.h>
+#include <xylose/nsort/map/w_species.h>
+#include <xylose/nsort/map/remap.h>
+#include <xylose/nsort/map/pivot.h>
+
+#include <xylose/Vector.h>
+#include <xylose/Dimensions.hpp>
+
+#define BOOST_TEST_MODULE  map_block
+
+#include <boost/test/unit_test.hpp>
+#include <vector>
+
+namespace {
+  using xylose::Vector;
+  using xylose::V3;
+  using xylose::Dimensions;
+
+  struct UniformGrid {
+    Vector<double,3u> x0() const { return V3( -5.0, -2.5, -1.0 ); }
+    Vector<double,3u> dx() const { return V3(  1.0,  0.5,  0.3 ); }
+    Vector<unsigned int,3u> size() const {
+      Vector<unsigned int,3u> retval;
+      retval[0] = 10u;
+      retval[1] = 5u;
+      retval[2] = 7u;
+      return retval;
+    }
+  };
+
+  struct Particle {
+    Vector<double, 3u> x;
+    unsigned int species;
+  };
+
+  inline const Vector<double,3u> & position( const Particle & p ) {
+    return p.x;
+  }
+
+  const unsigned int & species( const Particle & p ) {
+    return p.species;
+  }
+
+  /* more particles than a single block, including some outside of the grid. */
+  std::vector<Particle> make_particles() {
+    std::vector<Particle> p(1000);
+    for ( unsigned int k = 0; k < p.size(); ++k ) {
+      p[k].x = V3( -6.0 + 0.0123 * k, -3.0 + 0.0037 * (k % 997), 1.5 - 0.0029 * k );
+      p[k].species = k % 3u;
+    }
+    return p;
+  }
+
+  template < typename Map >
+  void check_block( const Map & map, const std::vector<Particle> & p ) {
+    const int n = p.size();
+    std::vector<int> key(n);
+    xylose::nsort::map::map_block( map, p.begin(), n, &key[0] );
+    for ( int k = 0; k < n; ++k )
+      BOOST_CHECK_EQUAL( key[k], map(p[k]) );
+  }
+}
+
+BOOST_AUTO_TEST_CASE( block_uniform_grid ) {
+  using xylose::nsort::map::uniform_grid;
+  UniformGrid grid;
+  std::vector<Particle> p = make_particles();
+
+  check_block( uniform_grid< UniformGrid, Dimensions<1u> >( grid ), p );
+  check_block( uniform_grid< UniformGrid, Dimensions<2u,0u> >( grid ), p );
+  check_block( uniform_grid< UniformGrid, Dimensions<0u,1u,2u> >( grid ), p );
+}
+
+BOOST_AUTO_TEST_CASE( block_w_species_remap ) {
+  using xylose::nsort::map::uniform_grid;
+  using xylose::nsort::map::w_species;
+  using xylose::nsort::map::remap;
+  typedef w_species< uniform_grid< UniformGrid, Dimensions<0u,1u,2u> > >
+    species_map;
+  typedef remap< species_map, 3u*350u > remap_t;
+
+  UniformGrid grid;
+  std::vector<Particle> p = make_particles();
+
+  species_map smap( std::make_pair( 3u, &grid ) );
+  check_block( smap, p );
+
+  remap_t rmap( std::make_pair( 3u, &grid ) );
+  for ( unsigned int i = 0; i < remap_t::number_values; ++i )
+    rmap.m_remap[i] = remap_t::number_values - 1 - i;
+  check_block( rmap, p );
+}
+
+BOOST_AUTO_TEST_CASE( block_generic ) {
+  using xylose::nsort::map::pivot;
+  std::vector<Particle> p = make_particles();
+  check_block( pivot< Dimensions<0u,2u> >( V3( 0.0, 0.0, 0.1 ) ), p );
+}
@@ -0,0 +1,124 @@
+/*==============================================================================
+ * Public Domain Contributions 2010 United States Government                   *
+ * as represented by the U.S. Air Force Research Laboratory.                   *
+ *                                                                             *
+ * This file is part of xylose                                                 *
+ *                                                                             *
+ * This program is free software: you can redistribute it and/or modify it     *
+ * under the terms of the GNU Lesser General Public License as published by    *
+ * the Free Software Foundation, either version 3 of the License, or (at your  *
+ * option) any later version.                                                  *
+ *                                                                             *
+ * This program is distributed in the hope that it will be useful, but WITHOUT *
+ * ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or       *
+ * FITNESS FOR A PARTICULAR PURPOSE.  See the GNU Lesser General Public        *
+ * License for more details.                                                   *
+ *                                                                             *
+ * You should have received a copy of the GNU Lesser General Public License    *
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.       *
+ *                                                                             *
+ -----------------------------------------------------------------------------*/
+
+
+
+#include <xylose/nsort/map/hilbert.h>
+
+#include <xylose/Vector.h>
+#include <xylose/Dimensions.hpp>
+
+#define BOOST_TEST_MODULE  hilbert
+
+#include <boost/test/unit_test.hpp>
+#include <vector>
+#include <cstdlib>
+
+namespace {
+  using xylose::Vector;
+  using xylose::V3;
+  using xylose::Dimensions;
+
+  struct UniformGrid {
+    Vector<unsigned int,3u> m_size;
+
+    UniformGrid( const unsigned int & n ) : m_size( n ) { }
+
+    Vector<double,3u> x0() const { return V3( 0.0, 0.0, 0.0 ); }
+    Vector<double,3u> dx() const { return V3( 1.0, 1.0, 1.0 ); }
+    const Vector<unsigned int,3u> & size() const { return m_size; }
+  };
+
+  struct Particle {
+    Vector<double, 3u> x;
+    Particle( const Vector<double,3u> & x = 0.0 ) : x(x) { }
+  };
+
+  inline const Vector<double,3u> & position( const Particle & p ) {
+    return p.x;
+  }
+
+  /** Check that the map is a bijection onto [0,n^dims) and that
+   * consecutive values along the curve are face neighbors. */
+  template < typename Map >
+  void check_curve( const Map & map, const int & n, const int & ndims ) {
+    const int nv = map.getNumberValues();
+    std::vector< Vector<int,3u> > cell( nv, Vector<int,3u>(-1) );
+
+    for ( int k = 0; k < (ndims > 2 ? n : 1); ++k )
+      for ( int j = 0; j < n; ++j )
+        for ( int i = 0; i < n; ++i ) {
+          const int h = map( Particle( V3( i + 0.5, j + 0.5, k + 0.5 ) ) );
+          BOOST_REQUIRE( h >= 0 && h < nv );
+          BOOST_CHECK_EQUAL( cell[h][0], -1 );
+          cell[h][0] = i;
+          cell[h][1] = j;
+          cell[h][2] = k;
+        }
+
+    for ( int h = 1; h < nv; ++h ) {
+      const int d = std::abs( cell[h][0] - cell[h-1][0] )
+                  + std::abs( cell[h][1] - cell[h-1][1] )
+                  + std::abs( cell[h][2] - cell[h-1][2] );
+      BOOST_CHECK_EQUAL( d, 1 );
+    }
+  }
+}
+
+BOOST_AUTO_TEST_CASE( hilbert_2D ) {
+  using xylose::nsort::map::hilbert;
+  UniformGrid grid( 8u );
+  hilbert< UniformGrid, Dimensions<0u,1u> > map( grid );
+
+  BOOST_CHECK_EQUAL( map.getNumberValues(), 64 );
+  BOOST_CHECK_EQUAL( map( Particle( V3( 0.5, 0.5, 0.0 ) ) ), 0 );
+  check_curve( map, 8, 2 );
+}
+
+BOOST_AUTO_TEST_CASE( hilbert_3D ) {
+  using xylose::nsort::map::hilbert;
+  UniformGrid grid( 4u );
+  hilbert< UniformGrid, Dimensions<0u,1u,2u> > map( grid );
+
+  BOOST_CHECK_EQUAL( map.getNumberValues(), 64 );
+  BOOST_CHECK_EQUAL( map( Particle( V3( 0.5, 0.5, 0.5 ) ) ), 0 );
+  check_curve( map, 4, 3 );
+}
+
+BOOST_AUTO_TEST_CASE( hilbert_compact ) {
+  using xylose::nsort::map::hilbert;
+  UniformGrid grid( 5u );
+  grid.m_size[2] = 3u;
+  hilbert< UniformGrid, Dimensions<0u,1u,2u> > map( grid );
+
+  /* only the actual cells are ranked along the (8x8x8) curve. */
+  BOOST_REQUIRE_EQUAL( map.getNumberValues(), 5 * 5 * 3 );
+  std::vector<int> seen( map.getNumberValues(), 0 );
+  for ( int k = 0; k < 3; ++k )
+    for ( int j = 0; j < 5; ++j )
+      for ( int i = 0; i < 5; ++i ) {
+        const int h = map( Particle( V3( i + 0.5, j + 0.5, k + 0.5 ) ) );
+        BOOST_REQUIRE( h >= 0 && h < map.getNumberValues() );
+        ++seen[h];
+      }
+  for ( unsigned int h = 0; h < seen.size(); ++h )
+    BOOST_CHECK_EQUAL( seen[h], 1 );
+}
@@ -0,0 +1,177 @@
+/*==============================================================================
+ * Public Domain Contributions 2010 United States Government                   *
+ * as represented by the U.S. Air Force Research Laboratory.                   *
+ *                                                                             *
+ * This file is part of xylose                                                 *
+ *                                                                             *
+ * This program is free software: you can redistribute it and/or modify it     *
+ * under the terms of the GNU Lesser General Public License as published by    *
+ * the Free Software Foundation, either version 3 of the License, or (at your  *
+ * option) any later version.                                                  *
+ *                                                                             *
+ * This program is distributed in the hope that it will be useful, but WITHOUT *
+ * ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or       *
+ * FITNESS FOR A PARTICULAR PURPOSE.  See the GNU Lesser General Public        *
+ * License for more details.                                                   *
+ *                                                                             *
+ * You should have received a copy of the GNU Lesser General Public License    *
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.       *
+ *                                                                             *
+ -----------------------------------------------------------------------------*/
+
+
+
+#include <xylose/nsort/map/morton.h>
+#include <xylose/nsort/map/w_species.h>
+#include <xylose/nsort/NSort.h>
+
+#include <xylose/Vector.h>
+#include <xylose/Dimensions.hpp>
+
+#define BOOST_TEST_MODULE  morton
+
+#include <boost/test/unit_test.hpp>
+#include <vector>
+
+namespace {
+  using xylose::Vector;
+  using xylose::V3;
+  using xylose::Dimensions;
+
+  struct UniformGrid {
+    Vector<unsigned int,3u> m_size;
+
+    UniformGrid( const unsigned int & nx,
+                 const unsigned int & ny,
+                 const unsigned int & nz ) {
+      m_size[0] = nx;
+      m_size[1] = ny;
+      m_size[2] = nz;
+    }
+
+    Vector<double,3u> x0() const { return V3( 0.0, 0.0, 0.0 ); }
+    Vector<double,3u> dx() const { return V3( 1.0, 1.0, 1.0 ); }
+    const Vector<unsigned int,3u> & size() const { return m_size; }
+  };
+
+  struct Particle {
+    Vector<double, 3u> x;
+    unsigned int species;
+    Particle( const Vector<double,3u> & x = 0.0,
+              const unsigned int & species = 0u )
+      : x(x), species(species) { }
+  };
+
+  inline const Vector<double,3u> & position( const Particle & p ) {
+    return p.x;
+  }
+
+  const unsigned int & species( const Particle & p ) {
+    return p.species;
+  }
+
+  Particle at( const int & i, const int & j, const int & k ) {
+    return Particle( V3( i + 0.5, j + 0.5, k + 0.5 ) );
+  }
+}
+
+BOOST_AUTO_TEST_CASE( morton_2D ) {
+  using xylose::nsort::map::morton;
+  UniformGrid grid( 4u, 4u, 1u );
+  morton< UniformGrid, Dimensions<0u,1u> > map( grid );
+
+  BOOST_CHECK_EQUAL( map.getNumberValues(), 16 );
+  BOOST_CHECK_EQUAL( map( at(0,0,0) ), 0 );
+  BOOST_CHECK_EQUAL( map( at(1,0,0) ), 1 );
+  BOOST_CHECK_EQUAL( map( at(0,1,0) ), 2 );
+  BOOST_CHECK_EQUAL( map( at(1,1,0) ), 3 );
+  BOOST_CHECK_EQUAL( map( at(2,0,0) ), 4 );
+  BOOST_CHECK_EQUAL( map( at(3,3,0) ), 15 );
+
+  /* positions outside of the grid are clamped as for uniform_grid. */
+  BOOST_CHECK_EQUAL( map( Particle( V3( -1.0, 10.0, 0.0 ) ) ), 10 );
+
+  /* non-power-of-two grids are not padded. */
+  UniformGrid grid2( 10u, 5u, 1u );
+  morton< UniformGrid, Dimensions<0u,1u> > map2( grid2 );
+  BOOST_CHECK_EQUAL( map2.getNumberValues(), 50 );
+}
+
+BOOST_AUTO_TEST_CASE( morton_compact ) {
+  using xylose::nsort::map::morton;
+  using xylose::nsort::map::detail::morton_index;
+  using xylose::nsort::map::detail::curve_bits;
+
+  /* a flat grid would need 2^30 buckets if each direction were padded to
+   * the largest one. */
+  const unsigned int n[3] = { 1024u, 6u, 3u };
+  UniformGrid grid( n[0], n[1], n[2] );
+  morton< UniformGrid, Dimensions<0u,1u,2u> > map( grid );
+  BOOST_REQUIRE_EQUAL( map.getNumberValues(), 1024 * 6 * 3 );
+
+  /* the map is a bijection onto [0,n_cells) that preserves the order of
+   * the (uncompacted) Morton index. */
+  const unsigned int b[3] = { curve_bits(n[0]), curve_bits(n[1]),
+                              curve_bits(n[2]) };
+  std::vector<int> seen( map.getNumberValues(), 0 );
+  std::vector< xylose::nsort::map::detail::curve_index >
+    code( map.getNumberValues() );
+  for ( unsigned int k = 0; k < n[2]; ++k )
+    for ( unsigned int j = 0; j < n[1]; ++j )
+      for ( unsigned int i = 0; i < n[0]; ++i ) {
+        const int v = map( at(i,j,k) );
+        BOOST_REQUIRE( v >= 0 && v < map.getNumberValues() );
+        ++seen[v];
+        const unsigned int X[3] = { i, j, k };
+        code[v] = morton_index( X, 3u, b );
+      }
+
+  for ( unsigned int v = 0; v < seen.size(); ++v )
+    BOOST_CHECK_EQUAL( seen[v], 1 );
+  for ( unsigned int v = 1; v < code.size(); ++v )
+    BOOST_CHECK_LT( code[v-1], code[v] );
+}
+
+BOOST_AUTO_TEST_CASE( morton_3D ) {
+  using xylose::nsort::map::morton;
+  UniformGrid grid( 4u, 4u, 4u );
+  morton< UniformGrid, Dimensions<0u,1u,2u> > map( grid );
+
+  BOOST_CHECK_EQUAL( map.getNumberValues(), 64 );
+  BOOST_CHECK_EQUAL( map( at(1,0,0) ), 1 );
+  BOOST_CHECK_EQUAL( map( at(0,1,0) ), 2 );
+  BOOST_CHECK_EQUAL( map( at(0,0,1) ), 4 );
+  BOOST_CHECK_EQUAL( map( at(2,0,0) ), 8 );
+
+  /* every cell maps to a distinct value. */
+  std::vector<int> seen( map.getNumberValues(), 0 );
+  for ( int k = 0; k < 4; ++k )
+    for ( int j = 0; j < 4; ++j )
+      for ( int i = 0; i < 4; ++i )
+        ++seen[ map( at(i,j,k) ) ];
+  for ( unsigned int v = 0; v < seen.size(); ++v )
+    BOOST_CHECK_EQUAL( seen[v], 1 );
+}
+
+BOOST_AUTO_TEST_CASE( morton_w_species_nsort ) {
+  using xylose::nsort::map::morton;
+  using xylose::nsort::map::w_species;
+  typedef w_species< morton< UniformGrid, Dimensions<0u,1u> > > map_t;
+
+  UniformGrid grid( 4u, 4u, 1u );
+  map_t map( std::make_pair( 2u, &grid ) );
+  BOOST_CHECK_EQUAL( map.getNumberValues(), 32 );
+
+  std::vector<Particle> p;
+  for ( int j = 3; j >= 0; --j )
+    for ( int i = 3; i >= 0; --i ) {
+      p.push_back( at(i,j,0) );
+      p.back().species = (i + j) % 2;
+    }
+
+  xylose::nsort::NSort< map_t > s( map.getNumberValues() );
+  s.sort( p.begin(), p.end(), map );
+
+  for ( unsigned int i = 1; i < p.size(); ++i )
+    BOOST_CHECK_LT( map( p[i-1] ), map( p[i] ) );
+}
@@ -21,6 +21,7 @@
 
 
 #include <xylose/nsort/map/remap.h>
+#include <xylose/nsort/map/static_remap.h>
 #include <xylose/nsort/map/pivot.h>
 
 #include <xylose/Vector.h>
@@ -29,6 +30,7 @@
 #define BOOST_TEST_MODULE  remap
 
 #include <boost/test/unit_test.hpp>
+#include <boost/mpl/vector_c.hpp>
 #include <iostream>
 
 
@@ -206,3 +208,76 @@ BOOST_AUTO_TEST_CASE( remap_3D ) {
 
 }
 
+BOOST_AUTO_TEST_CASE( remap_number_values ) {
+  using xylose::nsort::map::remap;
+  using xylose::nsort::map::pivot;
+  typedef remap< pivot< Dimensions<0u,1u,2u> > > map_t;
+  map_t rmap(V3(0,0,0));
+
+  BOOST_CHECK_EQUAL( rmap.getNumberValues(), 8 );
+
+  rmap.m_remap[1] = 0;
+  BOOST_CHECK_EQUAL( rmap.getNumberValues(), 7 );
+
+  /* rewriting the same value does not change anything. */
+  rmap.m_remap[1] = 0;
+  BOOST_CHECK_EQUAL( rmap.getNumberValues(), 7 );
+
+  rmap.m_remap[3] = 2;
+  rmap.m_remap[5] = 4;
+  rmap.m_remap[7] = 6;
+  BOOST_CHECK_EQUAL( rmap.getNumberValues(), 4 );
+
+  /* value 1 is used again. */
+  rmap.m_remap[7] = 1;
+  BOOST_CHECK_EQUAL( rmap.getNumberValues(), 5 );
+  rmap.m_remap[6] = rmap.m_remap[7];
+  BOOST_CHECK_EQUAL( rmap.getNumberValues(), 4 );
+
+  const int compact[8] = {0, 1, 2, -1, 3, -1, -1, -1};
+  for ( int i = 0; i < 8; ++i )
+    BOOST_CHECK_EQUAL( rmap.getCompactIndex()[i], compact[i] );
+
+  rmap.reset();
+  BOOST_CHECK_EQUAL( rmap.getNumberValues(), 8 );
+  BOOST_CHECK_EQUAL( rmap.getCompactIndex()[7], 7 );
+
+  /* compound updates are tracked as well. */
+  rmap.m_remap[1] -= 1;
+  BOOST_CHECK_EQUAL( rmap.getNumberValues(), 7 );
+  --rmap.m_remap[3];
+  BOOST_CHECK_EQUAL( rmap.m_remap[3]++, 2 );
+  BOOST_CHECK_EQUAL( rmap.getNumberValues(), 7 );
+  rmap.m_remap[3] += 0;
+  BOOST_CHECK_EQUAL( rmap.m_remap.data()[3], 3 );
+  BOOST_CHECK_EQUAL( rmap.getNumberValues(), 7 );
+}
+
+BOOST_AUTO_TEST_CASE( static_remap_2D ) {
+  using xylose::nsort::map::static_remap;
+  using xylose::nsort::map::pivot;
+  typedef static_remap< pivot< Dimensions<0u,1u> >,
+                        boost::mpl::vector_c<int, 0, 1, 0, 1> > map_t;
+  map_t rmap(V3(0,0,0));
+
+  BOOST_CHECK_EQUAL( static_cast<int>(map_t::number_values), 4 );
+  BOOST_CHECK_EQUAL( static_cast<int>(map_t::number_distinct), 2 );
+  BOOST_CHECK_EQUAL( rmap.getNumberValues(), 2 );
+
+  const int * table = rmap.m_remap;
+  BOOST_CHECK_EQUAL( table[2], 0 );
+  BOOST_CHECK_EQUAL( rmap.m_remap[3], 1 );
+
+  Particle p;
+  p.x[0] = -1; p.x[1] = -1;
+  BOOST_CHECK_EQUAL( rmap(p), 0 );
+
+  p.x[0] =  1; p.x[1] = -1;
+  BOOST_CHECK_EQUAL( rmap(p), 1 );
+
+  p.x[0] = -1; p.x[1] =  1;
+  BOOST_CHECK_EQUAL( rmap(p), 0 );
+
+  p.x[0] =  1; p.x[1] =  1;
+  BOOST_CHECK_EQUAL( rmap(p), 1 );
+}
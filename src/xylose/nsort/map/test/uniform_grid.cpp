@@ -213,3 +213,28 @@ BOOST_AUTO_TEST_CASE( map_uniform_grid_3D ) {
   }
 }
 
+BOOST_AUTO_TEST_CASE( map_uniform_grid_batch ) {
+  using xylose::nsort::map::uniform_grid;
+
+  typedef Dimensions<0u,1u,2u> dims;
+  UniformGrid< dims > grid;
+  grid.m_x0 = V3( -5.0, -2.5, -1.0 );
+  grid.m_dx = V3( 1.0, 0.5, 0.3 );
+  uniform_grid< UniformGrid<dims>, dims > map(grid);
+
+  const int n = 100;
+  double x[3][n];
+  for ( int k = 0; k < n; ++k ) {
+    /* includes positions outside of the grid in every direction. */
+    x[0][k] = -6.0 + 0.123 * k;
+    x[1][k] = -3.0 + 0.037 * k;
+    x[2][k] =  1.5 - 0.029 * k;
+  }
+
+  const double * xp[3] = { x[0], x[1], x[2] };
+  int cell[n];
+  map( xp, n, cell );
+
+  for ( int k = 0; k < n; ++k )
+    BOOST_CHECK_EQUAL( cell[k], map( Particle( V3(x[0][k], x[1][k], x[2][k]) ) ) );
+}
@@ -0,0 +1,179 @@
+/*==============================================================================
+ * Public Domain Contributions 2010 United States Government                   *
+ * as represented by the U.S. Air Force Research Laboratory.                   *
+ *                                                                             *
+ * This file is part of xylose                                                 *
+ *                                                                             *
+ * This program is free software: you can redistribute it and/or modify it     *
+ * under the terms of the GNU Lesser General Public License as published by    *
+ * the Free Software Foundation, either version 3 of the License, or (at your  *
+ * option) any later version.                                                  *
+ *                                                                             *
+ * This program is distributed in the hope that it will be useful, but WITHOUT *
+ * ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or       *
+ * FITNESS FOR A PARTICULAR PURPOSE.  See the GNU Lesser General Public        *
+ * License for more details.                                                   *
+ *                                                                             *
+ * You should have received a copy of the GNU Lesser General Public License    *
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.       *
+ *                                                                             *
+ -----------------------------------------------------------------------------*/
+
+
+
+
+#define BOOST_TEST_MODULE  Balance
+
+#include <xylose/nsort/tweak/Balance.h>
+#include <xylose/nsort/map/remap.h>
+#include <xylose/nsort/map/w_species.h>
+#include <xylose/nsort/NSort.h>
+#include <xylose/nsort/PNSort.h>
+
+#include <boost/test/unit_test.hpp>
+
+#include <vector>
+
+namespace {
+
+  struct Item {
+    int value;
+    int index;
+  };
+
+  /** Species used for the w_species maps. */
+  inline int species( const Item & i ) {
+    return i.index % 2;
+  }
+
+  struct item_value {
+    typedef void super;
+    static const unsigned int number_values = 20u;
+
+    int getNumberValues() const { return number_values; }
+
+    inline int operator()( const Item & i ) const {
+      return i.value;
+    }
+  };
+
+  typedef xylose::nsort::map::remap< item_value > remap_t;
+  typedef xylose::nsort::tweak::Balance Balance;
+
+  /* groups (of at least 10 items):  values 0-3 (46 items), 4-7 (10), 8-9
+   * (17), and 10-19 (11). */
+  const int counts[20] = {1, 2, 3, 40, 0, 0, 5, 5, 5, 12,
+                          1, 1, 1, 1, 1, 1, 1, 1, 1, 2};
+  const int group_of[20] = {0, 0, 0, 0, 1, 1, 1, 1, 2, 2,
+                            3, 3, 3, 3, 3, 3, 3, 3, 3, 3};
+  const int group_size[4] = {46, 10, 17, 11};
+
+  /* interleave the values; each value repeated counts[v]*scale times. */
+  std::vector<Item> make_items( const int & scale ) {
+    std::vector<Item> items;
+    for ( int r = 0; r < 40 * scale; ++r )
+      for ( int v = 0; v < 20; ++v )
+        if ( r < counts[v] * scale ) {
+          Item i = { v, static_cast<int>(items.size()) };
+          items.push_back( i );
+        }
+    return items;
+  }
+
+  template < typename Sorter >
+  void check_groups( const std::vector<Item> & items, const Sorter & s,
+                     const remap_t & rmap, const Balance & balance,
+                     const int & scale ) {
+    BOOST_CHECK_EQUAL( balance.getNumberGroups(), 4 );
+    BOOST_REQUIRE_EQUAL( balance.getOverfull().size(), 1u );
+    BOOST_CHECK_EQUAL( balance.getOverfull()[0], 0 );
+
+    for ( int v = 0; v < 20; ++v )
+      BOOST_CHECK_EQUAL( rmap.m_remap[v], group_of[v] );
+
+    for ( int g = 0; g < 4; ++g ) {
+      BOOST_CHECK_EQUAL( s.size(g), group_size[g] * scale );
+      for ( int i = s.begin(g); i < s.end(g); ++i )
+        BOOST_CHECK_EQUAL( group_of[ items[i].value ], g );
+    }
+    for ( int g = 4; g < 20; ++g )
+      BOOST_CHECK_EQUAL( s.size(g), 0 );
+  }
+}
+
+BOOST_AUTO_TEST_SUITE( tweak_Balance );
+
+BOOST_AUTO_TEST_CASE( sort ) {
+  std::vector<Item> items = make_items( 1 );
+  remap_t rmap;
+  Balance balance( 10, 30 );
+
+  xylose::nsort::NSort< remap_t, Balance > s( 20 );
+  s.sort( items.begin(), items.end(), rmap, balance );
+  check_groups( items, s, rmap, balance, 1 );
+}
+
+BOOST_AUTO_TEST_CASE( stable_sort ) {
+  std::vector<Item> items = make_items( 1 );
+  remap_t rmap;
+  Balance balance( 10, 30 );
+
+  xylose::nsort::NSort< remap_t, Balance > s( 20 );
+  s.stable_sort( items.begin(), items.end(), rmap, balance );
+  check_groups( items, s, rmap, balance, 1 );
+
+  for ( unsigned int i = 1; i < items.size(); ++i )
+    if ( group_of[ items[i-1].value ] == group_of[ items[i].value ] )
+      BOOST_CHECK_LT( items[i-1].index, items[i].index );
+}
+
+BOOST_AUTO_TEST_CASE( parallel_sort ) {
+  const int scale = 500;
+  std::vector<Item> items = make_items( scale );
+  remap_t rmap;
+  Balance balance( 10 * scale, 30 * scale );
+
+  xylose::PThreadCache cache;
+  cache.set_max_threads( 4 );
+  xylose::nsort::PNSort< remap_t, Balance > s( 20, cache );
+  s.sort( items.begin(), items.end(), rmap, balance );
+  check_groups( items, s, rmap, balance, scale );
+}
+
+BOOST_AUTO_TEST_CASE( w_species_remap ) {
+  typedef xylose::nsort::map::w_species< remap_t > map_t;
+  const int max_count = 20;
+
+  std::vector<Item> items = make_items( 1 );
+  map_t map( 2u );
+  Balance balance( 10, max_count );
+
+  xylose::nsort::NSort< map_t, Balance > s( 40 );
+  s.sort( items.begin(), items.end(), map, balance );
+
+  /* the values are grouped by the items of both species together. */
+  BOOST_CHECK_EQUAL( balance.getNumberGroups(), 4 );
+  for ( int v = 0; v < 20; ++v )
+    BOOST_CHECK_EQUAL( map.m_remap[v], group_of[v] );
+
+  std::vector<int> overfull;
+  for ( int g = 0; g < 4; ++g ) {
+    BOOST_CHECK_EQUAL( s.size(2*g) + s.size(2*g + 1), group_size[g] );
+    for ( int sp = 0; sp < 2; ++sp ) {
+      const int b = 2*g + sp;
+      for ( int i = s.begin(b); i < s.end(b); ++i ) {
+        BOOST_CHECK_EQUAL( group_of[ items[i].value ], g );
+        BOOST_CHECK_EQUAL( species( items[i] ), sp );
+      }
+      if ( s.size(b) > max_count )
+        overfull.push_back( b );
+    }
+  }
+  for ( int b = 8; b < 40; ++b )
+    BOOST_CHECK_EQUAL( s.size(b), 0 );
+
+  BOOST_CHECK( !overfull.empty() );
+  BOOST_CHECK( balance.getOverfull() == overfull );
+}
+
+BOOST_AUTO_TEST_SUITE_END();
@@ -26,7 +26,33 @@
 
 #include <boost/test/unit_test.hpp>
 #include <iostream>
+#include <vector>
 
+namespace {
+
+  struct Item {
+    int value;
+    int index;
+  };
+
+  struct item_value {
+    typedef void super;
+
+    inline int operator()( const Item & i ) const {
+      return i.value;
+    }
+  };
+
+  std::vector<Item> make_items( const int & len, const int * v ) {
+    std::vector<Item> items(len);
+    for ( int i = 0; i < len; ++i ) {
+      items[i].value = v[i];
+      items[i].index = i;
+    }
+    return items;
+  }
+
+}
 
 BOOST_AUTO_TEST_SUITE( NSort );
 
@@ -55,5 +81,184 @@ BOOST_AUTO_TEST_CASE( std_vector ) {
     BOOST_CHECK_EQUAL( sv[i], ans[i] );
 }
 
+BOOST_AUTO_TEST_CASE( stable_sort ) {
+  const int len = 10;
+  int v[len] = {1, 2, 0, 1, 2, 3, 0, 1, 2, 4};
+  int ans[len] = {0, 0, 1, 1, 1, 2, 2, 2, 3, 4};
+  int idx[len] = {2, 6, 0, 3, 7, 1, 4, 8, 5, 9};
+  std::vector<Item> items = make_items(len, v);
+
+  xylose::nsort::NSort<item_value> s(5);
+  s.stable_sort(items.begin(), items.end());
+
+  for (int i = 0; i < len; ++i) {
+    BOOST_CHECK_EQUAL( items[i].value, ans[i] );
+    BOOST_CHECK_EQUAL( items[i].index, idx[i] );
+  }
+
+  BOOST_CHECK_EQUAL( s.begin(1), 2 );
+  BOOST_CHECK_EQUAL( s.end(1), 5 );
+  BOOST_CHECK_EQUAL( s.size(4), 1 );
+
+  /* sort again to make sure that the pooled buffers can be reused. */
+  s.stable_sort(items.begin(), items.end());
+  for (int i = 0; i < len; ++i)
+    BOOST_CHECK_EQUAL( items[i].index, idx[i] );
+}
+
+BOOST_AUTO_TEST_CASE( stable_sort_copy ) {
+  const int len = 10;
+  int v[len] = {1, 2, 0, 1, 2, 3, 0, 1, 2, 4};
+  int ans[len] = {0, 0, 1, 1, 1, 2, 2, 2, 3, 4};
+  int idx[len] = {2, 6, 0, 3, 7, 1, 4, 8, 5, 9};
+  std::vector<Item> items = make_items(len, v);
+  std::vector<Item> out(len);
+
+  xylose::nsort::NSort<item_value> s(5);
+  s.stable_sort_copy(items.begin(), items.end(), out.begin());
+
+  for (int i = 0; i < len; ++i) {
+    BOOST_CHECK_EQUAL( out[i].value, ans[i] );
+    BOOST_CHECK_EQUAL( out[i].index, idx[i] );
+    /* input is left untouched. */
+    BOOST_CHECK_EQUAL( items[i].index, i );
+  }
+}
+
+BOOST_AUTO_TEST_CASE( resize ) {
+  const int len = 10;
+  int v[len] = {1, 2, 0, 1, 2, 3, 0, 1, 2, 4};
+  int ans[len] = {0, 0, 1, 1, 1, 2, 2, 2, 3, 4};
+
+  xylose::nsort::NSort<> s(8);
+  BOOST_CHECK_EQUAL( s.capacity(), 8 );
+
+  /* shrinking keeps the existing workspace. */
+  s.resize(5);
+  BOOST_CHECK_EQUAL( s.size(), 5 );
+  BOOST_CHECK_EQUAL( s.capacity(), 8 );
+
+  s.sort(static_cast<int*>(v), v+len);
+  for (int i = 0; i < len; ++i)
+    BOOST_CHECK_EQUAL( v[i], ans[i] );
+  BOOST_CHECK_EQUAL( s.end(4), len );
+
+  /* growing beyond the capacity reallocates. */
+  s.resize(20);
+  BOOST_CHECK_EQUAL( s.size(), 20 );
+  BOOST_CHECK_EQUAL( s.capacity(), 20 );
+
+  int w[len] = {19, 2, 0, 11, 2, 3, 0, 11, 2, 4};
+  int wans[len] = {0, 0, 2, 2, 2, 3, 4, 11, 11, 19};
+  s.sort(static_cast<int*>(w), w+len);
+  for (int i = 0; i < len; ++i)
+    BOOST_CHECK_EQUAL( w[i], wans[i] );
+  BOOST_CHECK_EQUAL( s.size(11), 2 );
+}
+
+BOOST_AUTO_TEST_CASE( external_arena ) {
+  const int len = 10;
+  int v[len] = {1, 2, 0, 1, 2, 3, 0, 1, 2, 4};
+  int ans[len] = {0, 0, 1, 1, 1, 2, 2, 2, 3, 4};
+  int arena[16];
+
+  xylose::nsort::NSort<> s(5, arena, 16);
+  BOOST_CHECK_EQUAL( s.capacity(), 8 );
+
+  s.sort(static_cast<int*>(v), v+len);
+  for (int i = 0; i < len; ++i)
+    BOOST_CHECK_EQUAL( v[i], ans[i] );
+
+  /* the bucket table lives in the provided arena. */
+  BOOST_CHECK_EQUAL( arena[0], 2 );
+  BOOST_CHECK_EQUAL( arena[4], len );
+
+  /* growing beyond the arena falls back to an owned workspace. */
+  s.resize(9);
+  BOOST_CHECK_EQUAL( s.capacity(), 9 );
+  s.sort(static_cast<int*>(v), v+len);
+  for (int i = 0; i < len; ++i)
+    BOOST_CHECK_EQUAL( v[i], ans[i] );
+}
+
+BOOST_AUTO_TEST_CASE( radix_sort ) {
+  const int len = 2000;
+  const int n_values = 1000;
+  std::vector<int> v(len);
+  for (int i = 0; i < len; ++i)
+    v[i] = (i * 7919) % n_values;
+  std::vector<Item> items = make_items(len, &v[0]);
+
+  xylose::nsort::NSort<item_value> ref(n_values);
+  std::vector<Item> ans = items;
+  ref.stable_sort(ans.begin(), ans.end());
+
+  /* exercise both an odd and an even number of passes. */
+  for (int bits = 3; bits <= 4; ++bits) {
+    std::vector<Item> sorted = items;
+    xylose::nsort::NSort<item_value> s(n_values);
+    s.setDigitBits(bits);
+    s.radix_sort(sorted.begin(), sorted.end());
+
+    for (int i = 0; i < len; ++i) {
+      BOOST_CHECK_EQUAL( sorted[i].value, ans[i].value );
+      BOOST_CHECK_EQUAL( sorted[i].index, ans[i].index );
+    }
+
+    for (int i = 0; i < n_values; ++i)
+      BOOST_CHECK_EQUAL( s.end(i), ref.end(i) );
+  }
+
+  /* a non-positive digit width is clamped to one bit per pass. */
+  {
+    std::vector<Item> sorted = items;
+    xylose::nsort::NSort<item_value> s(n_values);
+    s.setDigitBits(0);
+    BOOST_CHECK_EQUAL( s.getDigitBits(), 1 );
+    s.radix_sort(sorted.begin(), sorted.end());
+    for (int i = 0; i < len; ++i)
+      BOOST_CHECK_EQUAL( sorted[i].index, ans[i].index );
+  }
+}
+
+BOOST_AUTO_TEST_CASE( resort ) {
+  const int len = 1000;
+  const int n_values = 50;
+  std::vector<int> v(len);
+  for (int i = 0; i < len; ++i)
+    v[i] = (i * 37) % n_values;
+
+  xylose::nsort::NSort<> s(n_values);
+  /* the first call falls back to a full sort. */
+  s.resort(v.begin(), v.end());
+  for (int i = 1; i < len; ++i)
+    BOOST_CHECK_LE( v[i-1], v[i] );
+
+  for (int step = 0; step < 3; ++step) {
+    /* move a few items to a neighboring (or distant) bucket. */
+    for (int i = step; i < len; i += 23)
+      v[i] = (i % 3 == 0) ? (v[i] + 1) % n_values : (v[i] + 17) % n_values;
+
+    std::vector<int> count(n_values, 0);
+    for (int i = 0; i < len; ++i)
+      ++count[v[i]];
+
+    s.resort(v.begin(), v.end());
+
+    for (int i = 1; i < len; ++i)
+      BOOST_CHECK_LE( v[i-1], v[i] );
+    for (int i = 0; i < n_values; ++i) {
+      BOOST_CHECK_EQUAL( s.size(i), count[i] );
+      for (int j = s.begin(i); j < s.end(i); ++j)
+        BOOST_CHECK_EQUAL( v[j], i );
+    }
+  }
+
+  /* nothing moved. */
+  std::vector<int> before = v;
+  s.resort(v.begin(), v.end());
+  BOOST_CHECK( v == before );
+}
+
 BOOST_AUTO_TEST_SUITE_END();
 
@@ -0,0 +1,121 @@
+/*==============================================================================
+ * Public Domain Contributions 2010 United States Government                   *
+ * as represented by the U.S. Air Force Research Laboratory.                   *
+ *                                                                             *
+ * This file is part of xylose                                                 *
+ *                                                                             *
+ * This program is free software: you can redistribute it and/or modify it     *
+ * under the terms of the GNU Lesser General Public License as published by    *
+ * the Free Software Foundation, either version 3 of the License, or (at your  *
+ * option) any later version.                                                  *
+ *                                                                             *
+ * This program is distributed in the hope that it will be useful, but WITHOUT *
+ * ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or       *
+ * FITNESS FOR A PARTICULAR PURPOSE.  See the GNU Lesser General Public        *
+ * License for more details.                                                   *
+ *                                                                             *
+ * You should have received a copy of the GNU Lesser General Public License    *
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.       *
+ *                                                                             *
+ -----------------------------------------------------------------------------*/
+
+
+
+#define BOOST_TEST_MODULE  PNSort
+
+#include <xylose/nsort/PNSort.h>
+#include <xylose/nsort/NSort.h>
+
+#include <boost/test/unit_test.hpp>
+
+#include <vector>
+#include <cstdlib>
+#include <algorithm>
+
+namespace {
+
+  struct Item {
+    int value;
+    int index;
+  };
+
+  struct item_value {
+    typedef void super;
+
+    inline int operator()( const Item & i ) const {
+      return i.value;
+    }
+  };
+
+  std::vector<int> random_values( const int & len, const int & n_values ) {
+    std::vector<int> v(len);
+    srand(1);
+    for ( int i = 0; i < len; ++i )
+      v[i] = rand() % n_values;
+    return v;
+  }
+
+}
+
+BOOST_AUTO_TEST_SUITE( PNSort );
+
+BOOST_AUTO_TEST_CASE( small_range_uses_serial_sort ) {
+  const int len = 10;
+  int v[len] = {1, 2, 0, 1, 2, 3, 0, 1, 2, 4};
+  int ans[len] = {0, 0, 1, 1, 1, 2, 2, 2, 3, 4};
+
+  xylose::PThreadCache cache;
+  cache.set_max_threads(4);
+  xylose::nsort::PNSort<> s(len, cache);
+  s.sort(static_cast<int*>(v), v+len);
+
+  for (int i = 0; i < len; ++i)
+    BOOST_CHECK_EQUAL( v[i], ans[i] );
+}
+
+BOOST_AUTO_TEST_CASE( matches_serial_sort ) {
+  const int len = 200000;
+  const int n_values = 1000;
+  std::vector<int> pv = random_values( len, n_values );
+  std::vector<int> sv = pv;
+
+  xylose::PThreadCache cache;
+  cache.set_max_threads(4);
+  xylose::nsort::PNSort<> ps(n_values, cache);
+  xylose::nsort::NSort<> s(n_values);
+
+  ps.sort(pv.begin(), pv.end());
+  s.sort(sv.begin(), sv.end());
+
+  BOOST_CHECK( pv == sv );
+  for ( int i = 0; i < n_values; ++i ) {
+    BOOST_CHECK_EQUAL( ps.begin(i), s.begin(i) );
+    BOOST_CHECK_EQUAL( ps.end(i), s.end(i) );
+  }
+}
+
+BOOST_AUTO_TEST_CASE( stable ) {
+  const int len = 100000;
+  const int n_values = 17;
+  std::vector<int> v = random_values( len, n_values );
+  std::vector<Item> items(len);
+  for ( int i = 0; i < len; ++i ) {
+    items[i].value = v[i];
+    items[i].index = i;
+  }
+
+  xylose::PThreadCache cache;
+  cache.set_max_threads(3);
+  xylose::nsort::PNSort<item_value> ps(n_values, cache);
+  ps.sort(items.begin(), items.end());
+
+  for ( int b = 0; b < n_values; ++b ) {
+    for ( int i = ps.begin(b); i < ps.end(b); ++i ) {
+      BOOST_CHECK_EQUAL( items[i].value, b );
+      if ( i > ps.begin(b) )
+        BOOST_CHECK( items[i-1].index < items[i].index );
+    }
+  }
+}
+
+BOOST_AUTO_TEST_SUITE_END();
@@ -0,0 +1,154 @@
+/*==============================================================================
+ * Public Domain Contributions 2010 United States Government                   *
+ * as represented by the U.S. Air Force Research Laboratory.                   *
+ *                                                                             *
+ * This file is part of xylose                                                 *
+ *                                                                             *
+ * This program is free software: you can redistribute it and/or modify it     *
+ * under the terms of the GNU Lesser General Public License as published by    *
+ * the Free Software Foundation, either version 3 of the License, or (at your  *
+ * option) any later version.                                                  *
+ *                                                                             *
+ * This program is distributed in the hope that it will be useful, but WITHOUT *
+ * ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or       *
+ * FITNESS FOR A PARTICULAR PURPOSE.  See the GNU Lesser General Public        *
+ * License for more details.                                                   *
+ *                                                                             *
+ * You should have received a copy of the GNU Lesser General Public License    *
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.       *
+ *                                                                             *
+ -----------------------------------------------------------------------------*/
+
+
+
+
+#define BOOST_TEST_MODULE  PivotTree
+
+#include <xylose/nsort/PivotTree.h>
+
+#include <xylose/Vector.h>
+#include <xylose/Dimensions.hpp>
+
+#include <boost/test/unit_test.hpp>
+
+#include <vector>
+#include <cstdlib>
+
+namespace {
+  using xylose::Vector;
+  using xylose::V3;
+  using xylose::Dimensions;
+
+  struct Particle {
+    Vector<double,3u> x;
+    int id;
+  };
+
+  inline const Vector<double,3u> & position( const Particle & p ) {
+    return p.x;
+  }
+
+  /* clustered particles:  half uniform in the unit cube, half in a small
+   * dense region. */
+  std::vector<Particle> make_particles( const int & n ) {
+    std::srand(42);
+    std::vector<Particle> p(n);
+    for ( int i = 0; i < n; ++i ) {
+      const double s = ( i % 2 ) ? 1.0 : 0.01;
+      for ( unsigned int d = 0; d < 3u; ++d )
+        p[i].x[d] = s * ( std::rand() / (RAND_MAX + 1.0) );
+      p[i].id = i;
+    }
+    return p;
+  }
+
+  /* check that the tree covers all items, that the children of each node
+   * partition the node, that the items of each child are on the correct
+   * side of the pivot, and that leaves satisfy the leaf size. */
+  template < typename Tree >
+  void check_tree( const Tree & tree, const std::vector<Particle> & p,
+                   const int & n_children, const int & ndims ) {
+    const int N = p.size();
+    BOOST_REQUIRE( tree.size() > 0 );
+    BOOST_CHECK_EQUAL( tree[0].begin, 0 );
+    BOOST_CHECK_EQUAL( tree[0].end, N );
+
+    std::vector<int> seen( N, 0 );
+    int n_leaves = 0;
+    for ( int n = 0; n < tree.size(); ++n ) {
+      const typename Tree::Node & node = tree[n];
+      if ( node.isLeaf() ) {
+        ++n_leaves;
+        for ( int i = node.begin; i < node.end; ++i )
+          ++seen[ p[i].id ];
+        BOOST_CHECK( node.size() <= tree.getLeafSize()
+                     || node.depth == tree.getMaxDepth() );
+        continue;
+      }
+
+      BOOST_REQUIRE( node.first_child + n_children <= tree.size() );
+      int b = node.begin;
+      for ( int c = 0; c < n_children; ++c ) {
+        const typename Tree::Node & child = tree[node.first_child + c];
+        BOOST_CHECK_EQUAL( child.begin, b );
+        BOOST_CHECK_EQUAL( child.depth, node.depth + 1 );
+        b = child.end;
+
+        for ( int i = child.begin; i < child.end; ++i )
+          for ( int d = 0; d < ndims; ++d )
+            BOOST_CHECK_EQUAL( ( p[i].x[d] >= node.pivot[d] ),
+                               static_cast<bool>( (c >> d) & 1 ) );
+      }
+      BOOST_CHECK_EQUAL( b, node.end );
+    }
+
+    BOOST_CHECK( n_leaves > 1 );
+    for ( int i = 0; i < N; ++i )
+      BOOST_CHECK_EQUAL( seen[i], 1 );
+  }
+}
+
+BOOST_AUTO_TEST_SUITE( PivotTree );
+
+BOOST_AUTO_TEST_CASE( octree_centroid_serial ) {
+  typedef xylose::nsort::PivotTree<> Tree;
+  std::vector<Particle> p = make_particles( 5000 );
+
+  xylose::PThreadCache cache;
+  cache.set_max_threads(1);
+  Tree tree( 16, Tree::CENTROID, 32, cache );
+  tree.build( p.begin(), p.end() );
+  check_tree( tree, p, 8, 3 );
+}
+
+BOOST_AUTO_TEST_CASE( quadtree_median_parallel ) {
+  typedef xylose::nsort::PivotTree< Dimensions<0u,1u> > Tree;
+  std::vector<Particle> p = make_particles( 100000 );
+
+  xylose::PThreadCache cache;
+  cache.set_max_threads(4);
+  Tree tree( 32, Tree::MEDIAN, 32, cache );
+  tree.build( p.begin(), p.end() );
+  check_tree( tree, p, 4, 2 );
+
+  /* the median splits the root evenly along each direction. */
+  const int c0 = tree[0].first_child;
+  BOOST_CHECK_EQUAL( tree[c0 + 1].size() + tree[c0 + 3].size(), 100000 / 2 );
+  BOOST_CHECK_EQUAL( tree[c0 + 2].size() + tree[c0 + 3].size(), 100000 / 2 );
+}
+
+BOOST_AUTO_TEST_CASE( coincident_items ) {
+  typedef xylose::nsort::PivotTree<> Tree;
+  std::vector<Particle> p( 100 );
+  for ( int i = 0; i < 100; ++i ) {
+    p[i].x = V3( 0.5, 0.5, 0.5 );
+    p[i].id = i;
+  }
+
+  Tree tree( 4 );
+  tree.build( p.begin(), p.end() );
+  BOOST_CHECK_EQUAL( tree.size(), 1 );
+  BOOST_CHECK( tree[0].isLeaf() );
+}
+
+BOOST_AUTO_TEST_SUITE_END();
@@ -0,0 +1,115 @@
+/*==============================================================================
+ * Public Domain Contributions 2010 United States Government                   *
+ * as represented by the U.S. Air Force Research Laboratory.                   *
+ *                                                                             *
+ * This file is part of xylose                                                 *
+ *                                                                             *
+ * This program is free software: you can redistribute it and/or modify it     *
+ * under the terms of the GNU Lesser General Public License as published by    *
+ * the Free Software Foundation, either version 3 of the License, or (at your  *
+ * option) any later version.                                                  *
+ *                                                                             *
+ * This program is distributed in the hope that it will be useful, but WITHOUT *
+ * ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or       *
+ * FITNESS FOR A PARTICULAR PURPOSE.  See the GNU Lesser General Public        *
+ * License for more details.                                                   *
+ *                                                                             *
+ * You should have received a copy of the GNU Lesser General Public License    *
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.       *
+ *                                                                             *
+ -----------------------------------------------------------------------------*/
+
+
+
+
+#define BOOST_TEST_MODULE  bucket_ranges
+
+#include <xylose/nsort/utility/bucket_ranges.h>
+#include <xylose/nsort/NSort.h>
+
+#include <boost/test/unit_test.hpp>
+
+#include <vector>
+
+namespace {
+
+  typedef std::vector<int>::iterator Iter;
+
+  /* records the number of items of each bucket and whether all of the
+   * items of the bucket have the bucket's value. */
+  struct CheckBucket : xylose::DefaultPThreadFunctor {
+    int * count;
+    int * ok;
+
+    CheckBucket( int * count, int * ok ) : count(count), ok(ok) { }
+
+    template < typename Range >
+    void operator() ( const int & i, const Range & r ) {
+      count[i] = r.size();
+      ok[i] = 1;
+      for ( Iter it = r.begin(); it != r.end(); ++it )
+        if ( *it != i )
+          ok[i] = 0;
+    }
+  };
+
+  /* half of the items in the first few buckets to make the bucket sizes
+   * uneven. */
+  std::vector<int> make_values( const int & len, const int & n_values ) {
+    std::vector<int> v(len);
+    for ( int i = 0; i < len; ++i )
+      v[i] = ( i % 2 ) ? (i * 7919) % n_values : (i % 5);
+    return v;
+  }
+}
+
+BOOST_AUTO_TEST_SUITE( bucket_ranges );
+
+BOOST_AUTO_TEST_CASE( ranges ) {
+  using xylose::nsort::utility::make_bucket_ranges;
+  const int len = 10;
+  int v[len] = {1, 2, 0, 1, 2, 3, 0, 1, 2, 4};
+  std::vector<int> sv(v, v+len);
+
+  xylose::nsort::NSort<> s(5);
+  s.sort(sv.begin(), sv.end());
+
+  BOOST_CHECK_EQUAL( make_bucket_ranges( sv.begin(), s ).size(), 5 );
+  BOOST_CHECK( make_bucket_ranges( sv.begin(), s )[1].begin() == sv.begin() + 2 );
+  BOOST_CHECK_EQUAL( make_bucket_ranges( sv.begin(), s )[1].size(), 3u );
+  BOOST_CHECK_EQUAL( make_bucket_ranges( sv.begin(), s )[4].size(), 1u );
+
+  std::vector<int> count(5), ok(5);
+  CheckBucket f( &count[0], &ok[0] );
+  make_bucket_ranges( sv.begin(), s ).for_each( f );
+  for ( int i = 0; i < 5; ++i ) {
+    BOOST_CHECK_EQUAL( count[i], s.size(i) );
+    BOOST_CHECK_EQUAL( ok[i], 1 );
+  }
+}
+
+BOOST_AUTO_TEST_CASE( parallel_for_each_bucket ) {
+  const int len = 200000;
+  const int n_values = 1000;
+  std::vector<int> v = make_values( len, n_values );
+
+  xylose::nsort::NSort<> s(n_values);
+  s.sort(v.begin(), v.end());
+
+  xylose::PThreadCache cache;
+  for ( int threads = 1; threads <= 4; threads += 3 ) {
+    cache.set_max_threads( threads );
+
+    std::vector<int> count(n_values, -1), ok(n_values, 0);
+    xylose::nsort::utility::parallel_for_each_bucket(
+      v.begin(), s, CheckBucket( &count[0], &ok[0] ), cache );
+
+    /* each bucket visited exactly once. */
+    for ( int i = 0; i < n_values; ++i ) {
+      BOOST_CHECK_EQUAL( count[i], s.size(i) );
+      BOOST_CHECK_EQUAL( ok[i], 1 );
+    }
+  }
+}
+
+BOOST_AUTO_TEST_SUITE_END();
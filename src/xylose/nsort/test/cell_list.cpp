@@ -0,0 +1,230 @@
+/*==============================================================================
+ * Public Domain Contributions 2010 United States Government                   *
+ * as represented by the U.S. Air Force Research Laboratory.                   *
+ *                                                                             *
+ * This file is part of xylose                                                 *
+ *                                                                             *
+ * This program is free software: you can redistribute it and/or modify it     *
+ * under the terms of the GNU Lesser General Public License as published by    *
+ * the Free Software Foundation, either version 3 of the License, or (at your  *
+ * option) any later version.                                                  *
+ *                                                                             *
+ * This program is distributed in the hope that it will be useful, but WITHOUT *
+ * ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or       *
+ * FITNESS FOR A PARTICULAR PURPOSE.  See the GNU Lesser General Public        *
+ * License for more details.                                                   *
+ *                                                                             *
+ * You should have received a copy of the GNU Lesser General Public License    *
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.       *
+ *                                                                             *
+ -----------------------------------------------------------------------------*/
+
+
+
+
+#define BOOST_TEST_MODULE  cell_list
+
+#include <xylose/nsort/utility/cell_list.h>
+#include <xylose/nsort/NSort.h>
+#include <xylose/nsort/map/uniform_grid.h>
+#include <xylose/random/Kiss.hpp>
+#include <xylose/Vector.h>
+
+#include <boost/test/unit_test.hpp>
+
+#include <vector>
+#include <cstdlib>
+
+namespace {
+  using xylose::Vector;
+  using xylose::V3;
+
+  typedef xylose::Dimensions<0u,1u,2u> dims;
+
+  struct Grid {
+    Vector<double,3u> m_x0, m_dx;
+    Vector<unsigned int,3u> m_size;
+
+    Grid( const Vector<unsigned int,3u> & size )
+      : m_x0( 0.0 ), m_dx( 1.0 ), m_size( size ) { }
+
+    const Vector<double,3u> & x0() const { return m_x0; }
+    const Vector<double,3u> & dx() const { return m_dx; }
+    const Vector<unsigned int,3u> & size() const { return m_size; }
+  };
+
+  struct Particle {
+    Vector<double,3u> x;
+    int id;
+  };
+
+  inline const Vector<double,3u> & position( const Particle & p ) {
+    return p.x;
+  }
+
+  typedef xylose::nsort::map::uniform_grid<Grid,dims> map_t;
+  typedef std::vector<Particle>::iterator Iter;
+  typedef xylose::nsort::NSort<map_t> sorter_t;
+  typedef xylose::nsort::utility::cell_list<Iter,sorter_t,map_t> cells_t;
+
+  /* counts the neighbors of each particle and the number of pairs. */
+  struct CountNeighbors : xylose::DefaultPThreadFunctor {
+    int * count;
+    CountNeighbors( int * count ) : count(count) { }
+    void operator() ( const Particle & a, const Particle & ) {
+      ++count[a.id];
+    }
+  };
+
+  struct CountPairs {
+    int n_pairs;
+    int n_bad;
+    CountPairs() : n_pairs(0), n_bad(0) { }
+    void operator() ( const Particle & a, const Particle & b ) {
+      ++n_pairs;
+      if ( a.id == b.id )
+        ++n_bad;
+    }
+  };
+
+  std::vector<Particle> make_particles( const int & n, const Grid & g ) {
+    xylose::random::Kiss rng;
+    std::vector<Particle> pv(n);
+    for ( int i = 0; i < n; ++i ) {
+      for ( int d = 0; d < 3; ++d )
+        pv[i].x[d] = rng.rand() * g.size()[d];
+      pv[i].id = i;
+    }
+    return pv;
+  }
+
+  /* brute force: are the cells with coordinates a and b neighbors? */
+  bool adjacent( const int * a, const int * b,
+                 const Grid & g, const bool & periodic ) {
+    for ( int d = 0; d < 3; ++d ) {
+      int dx = std::abs( a[d] - b[d] );
+      if ( periodic )
+        dx = std::min( dx, static_cast<int>(g.size()[d]) - dx );
+      if ( dx > 1 )
+        return false;
+    }
+    return true;
+  }
+
+  /* expected number of neighbors of each particle by brute force over the
+   * cells. */
+  std::vector<int> expected_neighbors( const std::vector<Particle> & pv,
+                                       const Grid & g,
+                                       const bool & periodic ) {
+    const int nx = g.size()[0], ny = g.size()[1], nz = g.size()[2];
+    const int nc = nx * ny * nz;
+    std::vector<int> cell_count(nc, 0), cell(pv.size());
+    for ( unsigned int i = 0; i < pv.size(); ++i ) {
+      int c[3];
+      for ( int d = 0; d < 3; ++d )
+        c[d] = static_cast<int>( pv[i].x[d] );
+      cell[i] = c[0] + nx * ( c[1] + ny * c[2] );
+      ++cell_count[ cell[i] ];
+    }
+
+    std::vector<int> nbr_count(nc, 0);
+    for ( int i = 0; i < nc; ++i ) {
+      const int a[3] = { i % nx, (i / nx) % ny, i / (nx * ny) };
+      for ( int j = 0; j < nc; ++j ) {
+        const int b[3] = { j % nx, (j / nx) % ny, j / (nx * ny) };
+        if ( adjacent( a, b, g, periodic ) )
+          nbr_count[i] += cell_count[j];
+      }
+    }
+
+    std::vector<int> retval( pv.size() );
+    for ( unsigned int i = 0; i < pv.size(); ++i )
+      retval[ pv[i].id ] = nbr_count[ cell[i] ] - 1;
+    return retval;
+  }
+}
+
+BOOST_AUTO_TEST_SUITE( utility_cell_list );
+
+BOOST_AUTO_TEST_CASE( neighbors ) {
+  const Grid g( V3(4u,3u,2u) );
+  const map_t map(g);
+  sorter_t s( map.getNumberValues() );
+  std::vector<Particle> pv;
+  s.sort( pv.begin(), pv.end(), map );
+
+  cells_t cells( pv.begin(), s, map );
+  BOOST_CHECK_EQUAL( cells.shape(0), 4 );
+  BOOST_CHECK_EQUAL( cells.shape(1), 3 );
+  BOOST_CHECK_EQUAL( cells.shape(2), 2 );
+
+  int nbr[cells_t::max_neighbors];
+  /* corner, edge and interior cells with clamped boundaries. */
+  BOOST_CHECK_EQUAL( cells.neighbors( 0, nbr ), 8 );
+  BOOST_CHECK_EQUAL( nbr[0], 0 );
+  BOOST_CHECK_EQUAL( cells.neighbors( 1, nbr ), 12 );
+  BOOST_CHECK_EQUAL( cells.neighbors( 5, nbr ), 18 );
+
+  /* periodic: 3*3*2 (the z-direction only has two distinct cells). */
+  cells.setBoundary( 0, xylose::nsort::utility::PERIODIC );
+  cells.setBoundary( 1, xylose::nsort::utility::PERIODIC );
+  cells.setBoundary( 2, xylose::nsort::utility::PERIODIC );
+  BOOST_CHECK_EQUAL( cells.neighbors( 0, nbr ), 18 );
+  std::sort( nbr, nbr + 18 );
+  BOOST_CHECK( std::adjacent_find( nbr, nbr + 18 ) == nbr + 18 );
+  /* x: {3,0,1}, y: {2,0,1}, z: {1,0} -> largest is 3 + 4*2 + 12*1 */
+  BOOST_CHECK_EQUAL( nbr[17], 23 );
+}
+
+BOOST_AUTO_TEST_CASE( pairs ) {
+  const Grid g( V3(5u,4u,3u) );
+  const map_t map(g);
+  sorter_t s( map.getNumberValues() );
+
+  for ( int periodic = 0; periodic < 2; ++periodic ) {
+    std::vector<Particle> pv = make_particles( 2000, g );
+    s.sort( pv.begin(), pv.end(), map );
+
+    cells_t cells = xylose::nsort::utility::make_cell_list(
+      pv.begin(), s, map,
+      periodic ? xylose::nsort::utility::PERIODIC
+               : xylose::nsort::utility::CLAMPED );
+
+    const std::vector<int> expected = expected_neighbors( pv, g, periodic );
+    int total = 0;
+    for ( unsigned int i = 0; i < expected.size(); ++i )
+      total += expected[i];
+
+    CountPairs cp;
+    cells.for_each_pair( cp );
+    BOOST_CHECK_EQUAL( cp.n_bad, 0 );
+    BOOST_CHECK_EQUAL( 2 * cp.n_pairs, total );
+
+    std::vector<int> count( pv.size(), 0 );
+    CountNeighbors cn( &count[0] );
+    cells.for_each_neighbor( cn );
+    BOOST_CHECK( count == expected );
+  }
+}
+
+BOOST_AUTO_TEST_CASE( parallel_for_each_neighbor ) {
+  const Grid g( V3(8u,8u,8u) );
+  const map_t map(g);
+  sorter_t s( map.getNumberValues() );
+
+  std::vector<Particle> pv = make_particles( 20000, g );
+  s.sort( pv.begin(), pv.end(), map );
+  cells_t cells( pv.begin(), s, map, xylose::nsort::utility::PERIODIC );
+
+  const std::vector<int> expected = expected_neighbors( pv, g, true );
+
+  xylose::PThreadCache cache;
+  for ( int threads = 1; threads <= 4; threads += 3 ) {
+    cache.set_max_threads( threads );
+    std::vector<int> count( pv.size(), 0 );
+    cells.parallel_for_each_neighbor( CountNeighbors( &count[0] ), cache );
+    BOOST_CHECK( count == expected );
+  }
+}
+
+BOOST_AUTO_TEST_SUITE_END();
@@ -0,0 +1,185 @@
+/*==============================================================================
+ * Public Domain Contributions 2010 United States Government                   *
+ * as represented by the U.S. Air Force Research Laboratory.                   *
+ *                                                                             *
+ * This file is part of xylose                                                 *
+ *                                                                             *
+ * This program is free software: you can redistribute it and/or modify it     *
+ * under the terms of the GNU Lesser General Public License as published by    *
+ * the Free Software Foundation, either version 3 of the License, or (at your  *
+ * option) any later version.                                                  *
+ *                                                                             *
+ * This program is distributed in the hope that it will be useful, but WITHOUT *
+ * ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or       *
+ * FITNESS FOR A PARTICULAR PURPOSE.  See the GNU Lesser General Public        *
+ * License for more details.                                                   *
+ *                                                                             *
+ * You should have received a copy of the GNU Lesser General Public License    *
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.       *
+ *                                                                             *
+ -----------------------------------------------------------------------------*/
+
+
+
+#ifndef xylose_nsort_tweak_Balance_h
+#define xylose_nsort_tweak_Balance_h
+
+#include <xylose/nsort/tweak/traits.h>
+#include <xylose/nsort/map/remap.h>
+#include <xylose/nsort/map/w_species.h>
+
+#include <boost/static_assert.hpp>
+
+#include <vector>
+#include <limits>
+
+namespace xylose {
+  namespace nsort {
+    namespace tweak {
+
+      /** NSort tweaker that balances the number of items per bucket by
+       * rewriting the m_remap table of a map::remap value map.
+       *
+       * Using the counts of the preliminary counting pass, consecutive
+       * buckets are merged into groups of at least min_count items (a
+       * bucket that is already large enough forms a group by itself).  The
+       * groups become the new buckets 0..getNumberGroups()-1 (the remaining
+       * buckets are left empty):  the bucket-to-group map is composed into
+       * m_remap and the counts in bin are folded accordingly, all within the
+       * same sort call.  Groups with more than max_count items are recorded
+       * as overfull (see getOverfull()) so that the consumer of the sorted
+       * buckets can treat them specially (e.g. split the work of a single
+       * cell).
+       *
+       * The value map passed to the sort must either have the tag of a
+       * map::remap or be a map::w_species that wraps a map::remap (this is
+       * checked at compile time).  For w_species, the buckets of all species
+       * of a remapped value are kept together:  consecutive remapped values
+       * are merged until the items of all of their species make up
+       * min_count, such that the buckets after merging are
+       * <code>n_species * group + species</code>.  Merged buckets cannot be
+       * split again, so the remap should be reset() before sorting to
+       * rebalance from scratch.  Because the results of the tweaker are
+       * stored in the tweaker, use the sort overloads that take the tweaker
+       * by reference to inspect them.
+       */
+      struct Balance {
+        /* MEMBER STORAGE */
+      private:
+        int min_count;
+        int max_count;
+        int n_groups;
+
+        /** Bucket to group map. */
+        std::vector<int> group;
+
+        /** Overfull groups. */
+        std::vector<int> overfull;
+
+
+        /* MEMBER FUNCTIONS */
+      public:
+        /** Constructor.
+         * @param min_count
+         *    Minimum number of items per bucket after merging.
+         * @param max_count
+         *    Buckets with more items are recorded as overfull
+         *    [Default:  no limit].
+         */
+        Balance( const int & min_count = 1,
+                 const int & max_count = std::numeric_limits<int>::max() )
+          : min_count(min_count), max_count(max_count), n_groups(0) { }
+
+        /** Merge the sparse buckets. */
+        template < typename Map >
+        void tweakNSort( Map & map, int * bin, const int & n_values ) {
+          tweak( map, bin, n_values, typename Map::tag() );
+        }
+
+        /** The number of (non-empty) groups of remapped values after the
+         * last sort.  Without w_species this is the number of buckets. */
+        const int & getNumberGroups() const { return n_groups; }
+
+        /** The buckets of the last sort with more than max_count items. */
+        const std::vector<int> & getOverfull() const { return overfull; }
+
+      private:
+        template < typename Map, typename T >
+        void tweak( Map & map, int * bin, const int & n_values,
+                    const map::tag::remap<T> & ) {
+          balance( map, bin, n_values, 1 );
+        }
+
+        template < typename Map >
+        void tweak( Map & map, int * bin, const int & n_values,
+                    const map::tag::w_species & ) {
+          typedef typename Map::super super;
+          BOOST_STATIC_ASSERT(( is_remap<typename super::tag>::value ));
+          balance( static_cast<super&>(map), bin, n_values,
+                   static_cast<int>(map.n_species) );
+        }
+
+        /** Only remap and w_species<remap> are supported. */
+        template < typename Tag >
+        struct is_remap {
+          static const bool value = false;
+        };
+
+        template < typename T >
+        struct is_remap< map::tag::remap<T> > {
+          static const bool value = true;
+        };
+
+        /** Merge the remapped values of rmap, where bucket
+         * <code>ns * value + s</code> holds the items of species s. */
+        template < typename Remap >
+        void balance( Remap & rmap, int * bin, const int & n_values,
+                      const int & ns ) {
+          const int n_remap = n_values / ns;
+          group.resize( n_remap );
+          overfull.clear();
+
+          /* group consecutive values until each group has enough items. */
+          n_groups = 0;
+          for ( int b = 0, count = 0; b < n_remap; ++b ) {
+            group[b] = n_groups;
+            for ( int s = 0; s < ns; ++s )
+              count += bin[ns*b + s];
+            if ( count >= min_count ) {
+              ++n_groups;
+              count = 0;
+            }
+          }
+
+          /* the trailing buckets that did not make a group of their own are
+           * merged into the last group. */
+          if ( n_groups == 0 )
+            n_groups = 1;
+          else
+            for ( int b = n_remap - 1; b >= 0 && group[b] == n_groups; --b )
+              group[b] = n_groups - 1;
+
+          /* fold the counts.  Since group[b] <= b, this can be done in
+           * place. */
+          for ( int b = 0; b < n_remap; ++b )
+            for ( int s = 0; s < ns; ++s ) {
+              const int count = bin[ns*b + s];
+              bin[ns*b + s] = 0;
+              bin[ns*group[b] + s] += count;
+            }
+
+          for ( int b = 0; b < ns * n_groups; ++b )
+            if ( bin[b] > max_count )
+              overfull.push_back( b );
+
+          /* compose the group map into the remap. */
+          for ( unsigned int i = 0; i < Remap::number_values; ++i )
+            rmap.m_remap[i] = group[ rmap.m_remap[i] ];
+        }
+      };
+
+    }/* namespace tweak */
+  }/* namespace nsort */
+}/* namespace xylose */
+
+#endif // xylose_nsort_tweak_Balance_h
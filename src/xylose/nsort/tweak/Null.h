@@ -23,6 +23,8 @@
 #ifndef xylose_nsort_tweak_Null_h
 #define xylose_nsort_tweak_Null_h
 
+#include <xylose/nsort/tweak/traits.h>
+
 namespace xylose {
   namespace nsort {
     namespace tweak {
@@ -33,6 +35,12 @@ namespace xylose {
                                 const int * const bin,
                                 const int & n_values ) const {}
       };
+
+      /** The Null tweaker does not modify the map. */
+      template <>
+      struct traits<Null> {
+        static const bool modifies_map = false;
+      };
     }/* namespace tweak */
   }/* namespace nsort */
 }/* namespace xylose */
@@ -0,0 +1,49 @@
+/*==============================================================================
+ * Public Domain Contributions 2010 United States Government                   *
+ * as represented by the U.S. Air Force Research Laboratory.                   *
+ *                                                                             *
+ * This file is part of xylose                                                 *
+ *                                                                             *
+ * This program is free software: you can redistribute it and/or modify it     *
+ * under the terms of the GNU Lesser General Public License as published by    *
+ * the Free Software Foundation, either version 3 of the License, or (at your  *
+ * option) any later version.                                                  *
+ *                                                                             *
+ * This program is distributed in the hope that it will be useful, but WITHOUT *
+ * ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or       *
+ * FITNESS FOR A PARTICULAR PURPOSE.  See the GNU Lesser General Public        *
+ * License for more details.                                                   *
+ *                                                                             *
+ * You should have received a copy of the GNU Lesser General Public License    *
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.       *
+ *                                                                             *
+ -----------------------------------------------------------------------------*/
+
+
+
+#ifndef xylose_nsort_tweak_traits_h
+#define xylose_nsort_tweak_traits_h
+
+namespace xylose {
+  namespace nsort {
+    namespace tweak {
+
+      /** Properties of an NSort tweaker.
+       *
+       * modifies_map:  whether tweakNSort(...) may change the value map (and
+       * fold the counts in bin accordingly).  The sorts that cache the mapped
+       * value of each item (NSort::stable_sort(...), etc.) or keep separate
+       * counts (PNSort) must then re-map the items after tweakNSort(...).
+       * Tweakers are conservatively assumed to modify the map; specialize
+       * this class for tweakers that do not.
+       */
+      template < typename Tweaker >
+      struct traits {
+        static const bool modifies_map = true;
+      };
+
+    }/* namespace tweak */
+  }/* namespace nsort */
+}/* namespace xylose */
+
+#endif // xylose_nsort_tweak_traits_h
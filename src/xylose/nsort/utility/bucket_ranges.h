@@ -0,0 +1,192 @@
+/*==============================================================================
+ * Public Domain Contributions 2010 United States Government                   *
+ * as represented by the U.S. Air Force Research Laboratory.                   *
+ *                                                                             *
+ * This file is part of xylose                                                 *
+ *                                                                             *
+ * This program is free software: you can redistribute it and/or modify it     *
+ * under the terms of the GNU Lesser General Public License as published by    *
+ * the Free Software Foundation, either version 3 of the License, or (at your  *
+ * option) any later version.                                                  *
+ *                                                                             *
+ * This program is distributed in the hope that it will be useful, but WITHOUT *
+ * ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or       *
+ * FITNESS FOR A PARTICULAR PURPOSE.  See the GNU Lesser General Public        *
+ * License for more details.                                                   *
+ *                                                                             *
+ * You should have received a copy of the GNU Lesser General Public License    *
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.       *
+ *                                                                             *
+ -----------------------------------------------------------------------------*/
+
+
+
+#ifndef xylose_nsort_utility_bucket_ranges_h
+#define xylose_nsort_utility_bucket_ranges_h
+
+#include <xylose/IteratorRange.h>
+#include <xylose/PThreadEval.h>
+
+#include <algorithm>
+
+namespace xylose {
+  namespace nsort {
+    namespace utility {
+
+      /** View of the buckets of a sorted range as IteratorRanges.
+       *
+       * @tparam ParticleIterator
+       *    The type of iterator of the sorted range.
+       *
+       * @tparam Sorter
+       *    The sorter (NSort, PNSort, ...) that provides the bucket table
+       *    (size(), begin(i), end(i)).
+       *
+       * The view only references the sorter, so it is only valid as long as
+       * the bucket table of the sorter is (i.e. until the next sort).
+       */
+      template < typename ParticleIterator, typename Sorter >
+      class bucket_ranges {
+        /* TYPEDEFS */
+      public:
+        typedef xylose::IteratorRange<ParticleIterator> Range;
+
+      private:
+        /** Calls the functor for each bucket of [b0,b1). */
+        template < typename Functor >
+        struct BucketTask : DefaultPThreadFunctor {
+          const bucket_ranges * buckets;
+          int b0, b1;
+          Functor f;
+
+          BucketTask( const bucket_ranges * buckets,
+                      const int & b0, const int & b1, const Functor & f )
+            : buckets(buckets), b0(b0), b1(b1), f(f) { }
+
+          void operator() () {
+            for ( int i = b0; i < b1; ++i )
+              f( i, (*buckets)[i] );
+          }
+        };
+
+
+        /* MEMBER STORAGE */
+        /** The beginning of the sorted range. */
+        ParticleIterator first;
+
+        /** The sorter that holds the bucket table. */
+        const Sorter & s;
+
+        /** Minimum number of items handed to each task. */
+        static const int min_chunk_size = 1024;
+
+
+        /* MEMBER FUNCTIONS */
+      public:
+        /** Constructor.
+         * @param first
+         *    The beginning of the range sorted by s.
+         * @param s
+         *    The sorter.
+         */
+        bucket_ranges( const ParticleIterator & first, const Sorter & s )
+          : first(first), s(s) { }
+
+        /** Number of buckets. */
+        int size() const { return s.size(); }
+
+        /** The range of items of the ith bucket. */
+        Range operator[] ( const int & i ) const {
+          return Range( first + s.begin(i), first + s.end(i) );
+        }
+
+        /** Call <code>f(i, (*this)[i])</code> for each bucket in turn. */
+        template < typename Functor >
+        void for_each( Functor & f ) const {
+          for ( int i = 0, n = size(); i < n; ++i )
+            f( i, (*this)[i] );
+        }
+
+        /** Call <code>f(i, (*this)[i])</code> for each bucket, distributing
+         * the buckets over the threads of the cache.
+         *
+         * The buckets are split into contiguous groups that contain (nearly)
+         * the same number of items, rather than the same number of buckets.
+         * A few groups are made per thread so that the cache can balance the
+         * remaining differences.  Like all PThreadEval functors, the functor
+         * is copied into each task; results must therefore be returned via
+         * pointers or references held by the functor.  The functor may be
+         * called concurrently for different buckets.
+         *
+         * If the cache only has one thread (or there are too few items), the
+         * buckets are processed in the calling thread.
+         */
+        template < typename Functor >
+        void parallel_for_each( const Functor & f,
+                                PThreadCache & cache = xylose::pthreadCache )
+          const {
+          const int n = size();
+          if ( n == 0 )
+            return;
+
+          const int N = s.end( n - 1 );
+          const int n_chunks =
+            std::min( n, std::min( 4 * cache.get_max_threads(),
+                                   N / min_chunk_size ) );
+          if ( n_chunks <= 1 ) {
+            BucketTask<Functor>( this, 0, n, f )();
+            return;
+          }
+
+          PThreadEval< BucketTask<Functor> > eval(cache);
+          for ( int t = 0, b0 = 0; t < n_chunks && b0 < n; ++t ) {
+            /* the group ends at the first bucket that ends at or beyond this
+             * group's share of the items. */
+            const int target = static_cast<int>(
+              ( static_cast<double>(N) * (t + 1) ) / n_chunks );
+            int lo = b0, hi = n - 1;
+            while ( lo < hi ) {
+              const int mid = (lo + hi) / 2;
+              if ( s.end(mid) < target )
+                lo = mid + 1;
+              else
+                hi = mid;
+            }
+            const int b1 = ( t == n_chunks - 1 ) ? n : lo + 1;
+            eval.eval( BucketTask<Functor>( this, b0, b1, f ) );
+            b0 = b1;
+          }
+          eval.joinAll();
+        }
+      };
+
+      template < typename ParticleIterator, typename Sorter >
+      const int bucket_ranges<ParticleIterator,Sorter>::min_chunk_size;
+
+
+      /** Construct a bucket_ranges view of the range sorted by s. */
+      template < typename ParticleIterator, typename Sorter >
+      inline bucket_ranges<ParticleIterator,Sorter>
+      make_bucket_ranges( const ParticleIterator & first, const Sorter & s ) {
+        return bucket_ranges<ParticleIterator,Sorter>( first, s );
+      }
+
+      /** Call <code>f(i, range_i)</code> for each bucket of the range sorted
+       * by s, distributing the buckets over the threads of the cache.
+       * @see bucket_ranges::parallel_for_each.
+       */
+      template < typename ParticleIterator, typename Sorter, typename Functor >
+      inline void parallel_for_each_bucket(
+                              const ParticleIterator & first,
+                              const Sorter & s,
+                              const Functor & f,
+                              PThreadCache & cache = xylose::pthreadCache ) {
+        bucket_ranges<ParticleIterator,Sorter>( first, s )
+          .parallel_for_each( f, cache );
+      }
+
+    }/* namespace xylose::nsort::utility */
+  }/* namespace xylose::nsort */
+}/* namespace xylose */
+
+#endif // xylose_nsort_utility_bucket_ranges_h
@@ -0,0 +1,315 @@
+/*==============================================================================
+ * Public Domain Contributions 2010 United States Government                   *
+ * as represented by the U.S. Air Force Research Laboratory.                   *
+ *                                                                             *
+ * This file is part of xylose                                                 *
+ *                                                                             *
+ * This program is free software: you can redistribute it and/or modify it     *
+ * under the terms of the GNU Lesser General Public License as published by    *
+ * the Free Software Foundation, either version 3 of the License, or (at your  *
+ * option) any later version.                                                  *
+ *                                                                             *
+ * This program is distributed in the hope that it will be useful, but WITHOUT *
+ * ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or       *
+ * FITNESS FOR A PARTICULAR PURPOSE.  See the GNU Lesser General Public        *
+ * License for more details.                                                   *
+ *                                                                             *
+ * You should have received a copy of the GNU Lesser General Public License    *
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.       *
+ *                                                                             *
+ -----------------------------------------------------------------------------*/
+
+
+
+#ifndef xylose_nsort_utility_cell_list_h
+#define xylose_nsort_utility_cell_list_h
+
+#include <xylose/nsort/utility/bucket_ranges.h>
+#include <xylose/Vector.h>
+
+#include <algorithm>
+#include <cassert>
+
+namespace xylose {
+  namespace nsort {
+    namespace utility {
+
+      /** Treatment of the neighbors of cells at the edges of the grid. */
+      enum CellBoundary {
+        /** Cells beyond the edge of the grid do not exist. */
+        CLAMPED,
+        /** The grid wraps around at its edges. */
+        PERIODIC
+      };
+
+      namespace detail {
+        /** Extracts the number of cells along each of the sorted directions
+         * (in the order of dims) from the full 3D size of the grid. */
+        template < typename dims, unsigned int ndims = dims::ndims >
+        struct cell_shape;
+
+        template < typename dims >
+        struct cell_shape<dims,1u> {
+          static void get( const Vector<unsigned int,3u> & sz, int * n ) {
+            n[0] = sz[dims::dir0];
+          }
+        };
+
+        template < typename dims >
+        struct cell_shape<dims,2u> {
+          static void get( const Vector<unsigned int,3u> & sz, int * n ) {
+            n[0] = sz[dims::dir0];
+            n[1] = sz[dims::dir1];
+          }
+        };
+
+        template < typename dims >
+        struct cell_shape<dims,3u> {
+          static void get( const Vector<unsigned int,3u> & sz, int * n ) {
+            n[0] = sz[dims::dir0];
+            n[1] = sz[dims::dir1];
+            n[2] = sz[dims::dir2];
+          }
+        };
+      }
+
+
+      /** Cell list built on a range sorted by a uniform_grid map.
+       *
+       * The cell list does not store anything per particle: it reuses the
+       * begin/end table of the sorter, so that the particles of each cell
+       * (and therefore of each neighborhood) are contiguous in memory.  The
+       * neighbors of a cell are the cell itself and the cells that are
+       * adjacent to it (at most 3, 9 or 27 cells in 1, 2 or 3 dimensions).
+       *
+       * @tparam ParticleIterator
+       *    The type of iterator of the sorted range.
+       *
+       * @tparam Sorter
+       *    The sorter (NSort, PNSort, ...) that sorted the range.
+       *
+       * @tparam Map
+       *    The uniform_grid map that the range was sorted with.  The cell
+       *    index must be the (unwrapped) uniform_grid index, i.e. the map
+       *    must not be wrapped by w_species, remap, etc.
+       *
+       * Like bucket_ranges, the cell list is only valid until the next sort.
+       * @see bucket_ranges.
+       */
+      template < typename ParticleIterator, typename Sorter, typename Map >
+      class cell_list : public bucket_ranges<ParticleIterator,Sorter> {
+        /* TYPEDEFS */
+      public:
+        typedef bucket_ranges<ParticleIterator,Sorter> super;
+        typedef typename Map::dimensions dimensions;
+
+        /** Maximum number of neighbors (including itself) of a cell. */
+        enum { max_neighbors = ( dimensions::ndims == 1u ?  3 :
+                                 dimensions::ndims == 2u ?  9 : 27 ) };
+
+      private:
+        /** Visits the neighbors of each particle of the cells handed to it by
+         * bucket_ranges::parallel_for_each. */
+        template < typename Functor >
+        struct NeighborTask : DefaultPThreadFunctor {
+          const cell_list * cells;
+          Functor f;
+
+          NeighborTask( const cell_list * cells, const Functor & f )
+            : cells(cells), f(f) { }
+
+          template < typename Range >
+          void operator() ( const int & i, const Range & r ) {
+            cells->visitNeighbors( i, r, f );
+          }
+        };
+
+
+        /* MEMBER STORAGE */
+        /** Number of cells along each of the sorted directions. */
+        int n[3];
+
+        /** Stride of the cell index along each of the sorted directions. */
+        int stride[3];
+
+        /** Boundary treatment along each of the sorted directions. */
+        CellBoundary boundary[3];
+
+
+        /* MEMBER FUNCTIONS */
+      public:
+        /** Constructor.
+         * @param first
+         *    The beginning of the range sorted by s.
+         * @param s
+         *    The sorter.
+         * @param map
+         *    The uniform_grid map that was used to sort the range.
+         * @param b
+         *    Boundary treatment for all directions [default CLAMPED].
+         */
+        cell_list( const ParticleIterator & first,
+                   const Sorter & s,
+                   const Map & map,
+                   const CellBoundary & b = CLAMPED )
+          : super( first, s ) {
+          n[0] = n[1] = n[2] = 1;
+          detail::cell_shape<dimensions>::get( map.g.size(), n );
+          stride[0] = 1;
+          stride[1] = n[0];
+          stride[2] = n[0] * n[1];
+          std::fill( boundary, boundary + 3, b );
+          assert( s.size() == map.getNumberValues() );
+        }
+
+        /** Set the boundary treatment along the ith sorted direction (the ith
+         * direction of Map::dimensions). */
+        void setBoundary( const unsigned int & i, const CellBoundary & b ) {
+          assert( i < dimensions::ndims );
+          boundary[i] = b;
+        }
+
+        /** Boundary treatment along the ith sorted direction. */
+        const CellBoundary & getBoundary( const unsigned int & i ) const {
+          return boundary[i];
+        }
+
+        /** Number of cells along the ith sorted direction. */
+        const int & shape( const unsigned int & i ) const { return n[i]; }
+
+        /** Store the indices of the neighbors of cell (including cell itself)
+         * in nbr and return their number.  nbr must have room for
+         * max_neighbors entries.  Each neighbor is only listed once, even for
+         * periodic directions with fewer than three cells.
+         */
+        int neighbors( const int & cell, int * nbr ) const {
+          /* the distinct neighbor coordinates along each direction. */
+          int c[3][3], nc[3] = {1, 1, 1};
+          c[1][0] = c[2][0] = 0;
+          for ( unsigned int d = 0u; d < dimensions::ndims; ++d ) {
+            const int x = ( cell / stride[d] ) % n[d];
+            nc[d] = 0;
+            for ( int o = -1; o <= 1; ++o ) {
+              int y = x + o;
+              if ( y < 0 || y >= n[d] ) {
+                if ( boundary[d] == CLAMPED )
+                  continue;
+                y = ( y + n[d] ) % n[d];
+              }
+              bool seen = false;
+              for ( int k = 0; k < nc[d]; ++k )
+                seen = seen || c[d][k] == y;
+              if ( !seen )
+                c[d][nc[d]++] = y;
+            }
+          }
+
+          int m = 0;
+          for ( int k2 = 0; k2 < nc[2]; ++k2 )
+            for ( int k1 = 0; k1 < nc[1]; ++k1 )
+              for ( int k0 = 0; k0 < nc[0]; ++k0 )
+                nbr[m++] = c[0][k0]
+                         + c[1][k1] * stride[1]
+                         + c[2][k2] * stride[2];
+          return m;
+        }
+
+        /** Call <code>f(a,b)</code> once for each unordered pair of distinct
+         * particles a, b that are in the same or in neighboring cells.
+         *
+         * This is the half-stencil visit: the pairs of a cell are visited
+         * with the cell itself and with each of its neighbors that has a
+         * larger index.  The functor may therefore update both particles
+         * (e.g. to apply equal and opposite forces), but the visit is serial.
+         */
+        template < typename Functor >
+        void for_each_pair( Functor & f ) const {
+          int nbr[max_neighbors];
+          for ( int i = 0, N = this->size(); i < N; ++i ) {
+            const typename super::Range ri = (*this)[i];
+            if ( ri.begin() == ri.end() )
+              continue;
+
+            for ( ParticleIterator a = ri.begin(); a != ri.end(); ++a ) {
+              ParticleIterator b = a;
+              for ( ++b; b != ri.end(); ++b )
+                f( *a, *b );
+            }
+
+            const int m = neighbors( i, nbr );
+            for ( int k = 0; k < m; ++k ) {
+              if ( nbr[k] <= i )
+                continue;
+              const typename super::Range rj = (*this)[ nbr[k] ];
+              for ( ParticleIterator a = ri.begin(); a != ri.end(); ++a )
+                for ( ParticleIterator b = rj.begin(); b != rj.end(); ++b )
+                  f( *a, *b );
+            }
+          }
+        }
+
+        /** Call <code>f(a,b)</code> for each particle a and each distinct
+         * particle b in the same or in a neighboring cell.
+         *
+         * This is the full-stencil visit: each pair is visited twice, once
+         * from each side.  The functor should only update a.
+         */
+        template < typename Functor >
+        void for_each_neighbor( Functor & f ) const {
+          for ( int i = 0, N = this->size(); i < N; ++i )
+            visitNeighbors( i, (*this)[i], f );
+        }
+
+        /** Parallel version of for_each_neighbor.
+         *
+         * The cells are distributed over the threads of the cache as by
+         * bucket_ranges::parallel_for_each.  Since every call only updates a
+         * and each a belongs to exactly one task, the functor does not need
+         * any locking so long as it only writes to a (and to storage owned by
+         * the functor's copy).
+         */
+        template < typename Functor >
+        void parallel_for_each_neighbor(
+                              const Functor & f,
+                              PThreadCache & cache = xylose::pthreadCache )
+          const {
+          super::parallel_for_each( NeighborTask<Functor>( this, f ), cache );
+        }
+
+      private:
+        /** Visit the neighbors of each particle of ri (cell i). */
+        template < typename Range, typename Functor >
+        void visitNeighbors( const int & i, const Range & ri,
+                             Functor & f ) const {
+          if ( ri.begin() == ri.end() )
+            return;
+
+          int nbr[max_neighbors];
+          const int m = neighbors( i, nbr );
+          for ( int k = 0; k < m; ++k ) {
+            const typename super::Range rj = (*this)[ nbr[k] ];
+            for ( ParticleIterator a = ri.begin(); a != ri.end(); ++a )
+              for ( ParticleIterator b = rj.begin(); b != rj.end(); ++b )
+                if ( a != b )
+                  f( *a, *b );
+          }
+        }
+      };
+
+
+      /** Construct a cell_list of the range sorted by s with the uniform_grid
+       * map. */
+      template < typename ParticleIterator, typename Sorter, typename Map >
+      inline cell_list<ParticleIterator,Sorter,Map>
+      make_cell_list( const ParticleIterator & first,
+                      const Sorter & s,
+                      const Map & map,
+                      const CellBoundary & b = CLAMPED ) {
+        return cell_list<ParticleIterator,Sorter,Map>( first, s, map, b );
+      }
+
+    }/* namespace xylose::nsort::utility */
+  }/* namespace xylose::nsort */
+}/* namespace xylose */
+
+#endif // xylose_nsort_utility_cell_list_h
@@ -0,0 +1,295 @@
+/*==============================================================================
+ * Public Domain Contributions 2010 United States Government                   *
+ * as represented by the U.S. Air Force Research Laboratory.                   *
+ *                                                                             *
+ * This file is part of xylose                                                 *
+ *                                                                             *
+ * This program is free software: you can redistribute it and/or modify it     *
+ * under the terms of the GNU Lesser General Public License as published by    *
+ * the Free Software Foundation, either version 3 of the License, or (at your  *
+ * option) any later version.                                                  *
+ *                                                                             *
+ * This program is distributed in the hope that it will be useful, but WITHOUT *
+ * ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or       *
+ * FITNESS FOR A PARTICULAR PURPOSE.  See the GNU Lesser General Public        *
+ * License for more details.                                                   *
+ *                                                                             *
+ * You should have received a copy of the GNU Lesser General Public License    *
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.       *
+ *                                                                             *
+ -----------------------------------------------------------------------------*/
+
+
+
+#ifndef xylose_nsort_utility_soa_particles_h
+#define xylose_nsort_utility_soa_particles_h
+
+#include <xylose/Vector.h>
+
+#include <vector>
+#include <iterator>
+#include <cstddef>
+
+namespace xylose {
+  namespace nsort {
+    namespace utility {
+
+      /** Particle container that stores each member of the particles in a
+       * separate array (structure of arrays).
+       *
+       * The position (three double columns) and species (unsigned int
+       * column) are always present; any other members (velocity, weight, ...)
+       * are added as additional columns with addColumn<T>().  The particles
+       * are visited by the sort maps through lightweight particle handles (see
+       * begin()/end()), for which the position(p) and species(p) accessors are
+       * provided, such that the existing maps (uniform_grid, w_species, ...)
+       * can be used unchanged.
+       *
+       * For uniform_grid maps (possibly wrapped by w_species and/or remap)
+       * the position columns are handed directly to the batch operator() of
+       * the map (see map_positions), such that the positions are not
+       * assembled particle by particle.
+       *
+       * Instead of swapping whole particles, sort(...) uses
+       * NSort::sort_permutation to compute the sorting permutation once and
+       * then gathers each column in turn into a second buffer, which is
+       * written sequentially and swapped with the column.  Only the members
+       * that the map needs are read while sorting.
+       */
+      class soa_particles {
+        /* TYPEDEFS */
+      private:
+        /** Type-erased column. */
+        struct column_base {
+          virtual ~column_base() { }
+          virtual void resize( const std::size_t & n ) = 0;
+          virtual void permute( const int * perm, const std::size_t & n ) = 0;
+        };
+
+        /** Column of type T along with its gather buffer. */
+        template < typename T >
+        struct column : column_base {
+          std::vector<T> data;
+          std::vector<T> buffer;
+
+          column( const std::size_t & n ) : data(n) { }
+
+          void resize( const std::size_t & n ) { data.resize(n); }
+
+          void permute( const int * perm, const std::size_t & n ) {
+            buffer.resize( n );
+            T * dst = &buffer[0];
+            const T * src = &data[0];
+            for ( std::size_t k = 0; k < n; ++k )
+              dst[k] = src[ perm[k] ];
+            data.swap( buffer );
+          }
+        };
+
+      public:
+        /** Handle to a single particle of the container. */
+        struct particle {
+          const soa_particles * c;
+          int i;
+
+          particle( const soa_particles * c = NULL, const int & i = 0 )
+            : c(c), i(i) { }
+        };
+
+        /** Random access iterator over the particle handles. */
+        class iterator {
+          mutable particle p;
+        public:
+          typedef std::random_access_iterator_tag iterator_category;
+          typedef particle value_type;
+          typedef std::ptrdiff_t difference_type;
+          typedef const particle * pointer;
+          typedef const particle & reference;
+
+          iterator( const soa_particles * c = NULL, const int & i = 0 )
+            : p(c, i) { }
+
+          reference operator* () const { return p; }
+          pointer operator-> () const { return &p; }
+
+          iterator & operator++ () { ++p.i; return *this; }
+          iterator & operator-- () { --p.i; return *this; }
+          iterator operator++ (int) { iterator t = *this; ++p.i; return t; }
+          iterator operator-- (int) { iterator t = *this; --p.i; return t; }
+          iterator & operator+= ( const difference_type & n ) {
+            p.i += n;
+            return *this;
+          }
+          iterator & operator-= ( const difference_type & n ) {
+            p.i -= n;
+            return *this;
+          }
+          iterator operator+ ( const difference_type & n ) const {
+            return iterator( p.c, p.i + n );
+          }
+          iterator operator- ( const difference_type & n ) const {
+            return iterator( p.c, p.i - n );
+          }
+          difference_type operator- ( const iterator & that ) const {
+            return p.i - that.p.i;
+          }
+
+          bool operator== ( const iterator & that ) const { return p.i == that.p.i; }
+          bool operator!= ( const iterator & that ) const { return p.i != that.p.i; }
+          bool operator<  ( const iterator & that ) const { return p.i <  that.p.i; }
+          bool operator<= ( const iterator & that ) const { return p.i <= that.p.i; }
+          bool operator>  ( const iterator & that ) const { return p.i >  that.p.i; }
+          bool operator>= ( const iterator & that ) const { return p.i >= that.p.i; }
+        };
+
+        enum {
+          /** Column index of the x-position (y and z follow). */
+          POSITION = 0,
+          /** Column index of the species. */
+          SPECIES = 3
+        };
+
+
+        /* MEMBER STORAGE */
+      private:
+        /** Number of particles. */
+        std::size_t n;
+
+        /** The columns. */
+        std::vector<column_base*> columns;
+
+        /** The position and species columns (also in columns). */
+        column<double> * pos[3];
+        column<unsigned int> * spec;
+
+        /** The sorting permutation. */
+        std::vector<int> perm;
+
+
+        /* MEMBER FUNCTIONS */
+      public:
+        /** Constructor creates the position and species columns for n
+         * particles. */
+        soa_particles( const std::size_t & n = 0u ) : n(n) {
+          for ( int d = 0; d < 3; ++d )
+            columns.push_back( pos[d] = new column<double>(n) );
+          columns.push_back( spec = new column<unsigned int>(n) );
+        }
+
+        /** Destructor frees the columns. */
+        ~soa_particles() {
+          for ( std::size_t c = 0; c < columns.size(); ++c )
+            delete columns[c];
+        }
+
+        /** Add a column of type T.
+         * @return The index of the new column.
+         */
+        template < typename T >
+        int addColumn() {
+          columns.push_back( new column<T>(n) );
+          return columns.size() - 1;
+        }
+
+        /** Access the data of column c, which must have been added as type T.
+         * The pointer is invalidated by resize(...) and sort(...). */
+        template < typename T >
+        T * getColumn( const int & c ) {
+          return n ? &static_cast<column<T>*>(columns[c])->data[0] : NULL;
+        }
+
+        template < typename T >
+        const T * getColumn( const int & c ) const {
+          return n ? &static_cast<const column<T>*>(columns[c])->data[0] : NULL;
+        }
+
+        /** Access the dth position column. */
+        double * x( const int & d ) { return getColumn<double>( POSITION + d ); }
+        const double * x( const int & d ) const {
+          return getColumn<double>( POSITION + d );
+        }
+
+        /** Access the species column. */
+        unsigned int * species() { return getColumn<unsigned int>( SPECIES ); }
+        const unsigned int * species() const {
+          return getColumn<unsigned int>( SPECIES );
+        }
+
+        /** Number of particles. */
+        std::size_t size() const { return n; }
+
+        /** Change the number of particles of all columns. */
+        void resize( const std::size_t & n ) {
+          this->n = n;
+          for ( std::size_t c = 0; c < columns.size(); ++c )
+            columns[c]->resize( n );
+        }
+
+        /** Position of the ith particle. */
+        Vector<double,3> position( const int & i ) const {
+          return V3( pos[0]->data[i], pos[1]->data[i], pos[2]->data[i] );
+        }
+
+        /** Species of the ith particle. */
+        const unsigned int & species( const int & i ) const {
+          return spec->data[i];
+        }
+
+        iterator begin() const { return iterator( this, 0 ); }
+        iterator end() const { return iterator( this, n ); }
+
+        /** Apply a permutation to all columns:  the kth particle becomes the
+         * (previous) perm[k]th particle. */
+        void permute( const int * perm ) {
+          for ( std::size_t c = 0; c < columns.size(); ++c )
+            columns[c]->permute( perm, n );
+        }
+
+        /** Stably sort the particles with the sorter s (NSort or any class
+         * that provides sort_permutation) and the value map. */
+        template < typename Sorter, typename Map >
+        void sort( Sorter & s, const Map & map ) {
+          perm.resize( n );
+          s.sort_permutation( begin(), end(), perm.begin(), map );
+          if ( n )
+            permute( &perm[0] );
+        }
+
+      private:
+        /** Not copyable. */
+        soa_particles( const soa_particles & );
+        /** Not assignable. */
+        soa_particles & operator=( const soa_particles & );
+      };
+
+      /** Position accessor for the sort maps. */
+      inline Vector<double,3> position( const soa_particles::particle & p ) {
+        return p.c->position( p.i );
+      }
+
+      /** Species accessor for the sort maps. */
+      inline const unsigned int & species( const soa_particles::particle & p ) {
+        return p.c->species( p.i );
+      }
+
+      /** Batch uniform_grid mapping of the particles [Ai,Ai+n) (found by
+       * argument dependent lookup from map::map_block):  the position
+       * columns are passed directly to the batch operator() of the map
+       * instead of gathering the positions particle by particle.
+       * @see map::detail::map_positions.
+       */
+      template < typename Map >
+      inline void map_positions( const Map & map,
+                                 const soa_particles::iterator & Ai,
+                                 const int & n, int * key ) {
+        const soa_particles & c = *Ai->c;
+        const int i = Ai->i;
+        const double * const x[3] = { c.x(0) + i, c.x(1) + i, c.x(2) + i };
+        map( x, n, key );
+      }
+
+    }/* namespace xylose::nsort::utility */
+  }/* namespace xylose::nsort */
+}/* namespace xylose */
+
+#endif // xylose_nsort_utility_soa_particles_h
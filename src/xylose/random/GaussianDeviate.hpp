@@ -33,10 +33,19 @@
 #define xylose_random_GaussianDeviate_h
 
 #include <xylose/random/Kiss.hpp>
+#include <xylose/random/ThreadRNG.hpp>
 
 namespace xylose {
   namespace random {
 
+    /** Gaussian deviate (Box-Muller) drawing from RNG.
+     *
+     * Note that the former public members <code>RNG & rng</code> and
+     * <code>static RNG global_rng</code> were removed in favor of the per
+     * thread generators of ThreadRNG:  use getRNG() instead of rng, and
+     * ThreadRNG<RNG>::per_thread() (or pass a generator to the constructor)
+     * instead of global_rng.
+     */
     template < typename RNG = xylose::random::Kiss >
     class GaussianDeviate {
       /* MEMBER STORAGE */
@@ -44,20 +53,27 @@ namespace xylose {
       int iset;
       double gset, csigma;
 
-    public:
-      /** Reference to the random number generator. */
-      RNG & rng;
-
-
-      /* STATIC STORAGE */
-    public:
-      static RNG global_rng;
+      /** The random number generator (NULL for the generator of the calling
+       * thread). */
+      RNG * rng;
 
 
       /* MEMBER FUNCTIONS */
     public:
-      GaussianDeviate( RNG & rng = global_rng )
-        : iset(0), gset(0), csigma(0), rng(rng) { }
+      /** Constructor.
+       * @param rng
+       *    The random number generator to use [default:  the generator of
+       *    the thread that draws, see ThreadRNG].  Note that the deviate
+       *    itself keeps the second deviate of each Box-Muller pair, so a
+       *    GaussianDeviate should still not be shared between threads.
+       */
+      GaussianDeviate( RNG & rng = ThreadRNG<RNG>::per_thread() )
+        : iset(0), gset(0), csigma(0), rng( ThreadRNG<RNG>::bind(rng) ) { }
+
+      /** The random number generator used by this deviate. */
+      RNG & getRNG() const {
+        return ThreadRNG<RNG>::select(rng);
+      }
 
       /** The following is for getting a gaussian distribution of random
        * numbers.  This function uses a Box-Muller transformation to get the normal
@@ -73,6 +89,7 @@ namespace xylose {
         } else {
           double fac, r, v1, v2;
           csigma = sigma;
+          RNG & rng = getRNG();
 
           do {
             /* We don't have an extra deviate handy, so
@@ -98,9 +115,6 @@ namespace xylose {
 
     };
 
-    template < typename RNG >
-    RNG GaussianDeviate<RNG>::global_rng;
-
   }/* namespace xylose::random */
 }/* namespace xylose */
 
@@ -64,6 +64,13 @@ namespace xylose {
          ::   speed and simplicity (for generators with that long a period) ::
          :: ::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::: ::
      * \endverbatim
+     *
+     * Kiss has no jump-ahead:  the x and y components are linear (over the
+     * integers mod 2^32 and over GF(2) respectively) and could be advanced
+     * in \f$ O(\log n) \f$, but the carry of the z/w component is only
+     * approximated by the shifts above, so that component has no algebraic
+     * skip-ahead and can only be stepped.  Use MersenneTwister::split (or
+     * Philox streams) to hand out non-overlapping streams to threads.
      */
     class Kiss : public detail::RandBase<Kiss> {
       /* TYPEDEFS */
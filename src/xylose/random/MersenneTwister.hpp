@@ -70,9 +70,12 @@
 #define xylose_random_MersenneTwister
 
 #include <xylose/random/detail/RandBase.hpp>
+#include <xylose/random/detail/gf2_polynomial.hpp>
 #include <xylose/Vector.h>
 
 #include <algorithm>
+#include <vector>
+#include <cstddef>
 
 namespace xylose {
   namespace random {
@@ -92,6 +95,64 @@ namespace xylose {
       /** StateVector type. */
       typedef xylose::Vector<uint32_t, state_length> StateVector;
 
+      /** Polynomial that advances the generator by a fixed number of steps.
+       * The jump polynomial for n steps is \f$ x^n \bmod \phi(x) \f$, where
+       * \f$ \phi \f$ is the (degree 19937) characteristic polynomial of the
+       * generator.  Computing it takes \f$ O(\log n) \f$ polynomial
+       * squarings, so a JumpPolynomial should be made once and reused for
+       * every jump of the same size.
+       *
+       * \f$ \phi \f$ itself is obtained (once, on first use) from the output
+       * of the generator by the Berlekamp-Massey algorithm; the first
+       * JumpPolynomial should therefore be made before any threads are
+       * started.
+       *
+       * See H. Haramoto, M. Matsumoto, T. Nishimura, F. Panneton and P.
+       * L'Ecuyer, "Efficient jump ahead for F2-linear random number
+       * generators", INFORMS J. on Computing 20(3), 385-390 (2008).
+       */
+      class JumpPolynomial {
+        /* MEMBER STORAGE */
+        detail::gf2_polynomial p;
+
+        /* MEMBER FUNCTIONS */
+      public:
+        /** Jump polynomial for n steps. */
+        explicit JumpPolynomial( const uint64_t & n )
+          : p( modulus().power(n) ) { }
+
+        /** Jump polynomial for 2^k steps. */
+        static JumpPolynomial pow2( const unsigned int & k ) {
+          return JumpPolynomial( modulus().power2(k) );
+        }
+
+        /** The coefficients of the polynomial. */
+        const detail::gf2_polynomial & get() const { return p; }
+
+      private:
+        JumpPolynomial( const detail::gf2_polynomial & p ) : p(p) { }
+
+        /** Arithmetic modulo the characteristic polynomial. */
+        static const detail::gf2_modulus & modulus() {
+          static const detail::gf2_modulus phi( characteristic() );
+          return phi;
+        }
+
+        /** The characteristic polynomial of the generator.  Since it is
+         * irreducible, any 2*19937 output bits determine it. */
+        static detail::gf2_polynomial characteristic() {
+          const int n = 2 * 19937;
+          MersenneTwister g( 5489u );
+          detail::gf2_polynomial bits( n / 32 + 1, 0u );
+          for ( int i = 0; i < n; ++i )
+            bits[i >> 5] |= ( g.randInt() & 1u ) << (i & 31);
+
+          detail::gf2_polynomial phi = detail::minimal_polynomial( bits, n );
+          assert( detail::degree(phi) == 19937 );
+          return phi;
+        }
+      };
+
     protected:
       /** Length of internal state vector. */
       static const unsigned int internal_state_length = 624;
@@ -144,6 +205,21 @@ namespace xylose {
         using std::copy;
         copy( in_state.val, in_state.val + internal_state_length, state.val );
         left = in_state[internal_state_length];
+        next = &state[0] + (internal_state_length + 1 - left);
+      }
+
+      /** Copy constructor (next must point into this state). */
+      MersenneTwister( const MersenneTwister & that )
+        : super(false), state( that.state ), left( that.left ) {
+        next = &state[0] + (internal_state_length + 1 - left);
+      }
+
+      /** Assignment (next must point into this state). */
+      MersenneTwister & operator= ( const MersenneTwister & that ) {
+        state = that.state;
+        left = that.left;
+        next = &state[0] + (internal_state_length + 1 - left);
+        return *this;
       }
 
       /* initializes state with a seed */
@@ -238,6 +314,37 @@ namespace xylose {
         return y;
       }
 
+      /** Store n numbers on [0,0xffffffff] in out.  Gives the same numbers
+       * as n calls to randInt(), but tempers each block of the state that
+       * is already generated in one tight loop (which the compiler can
+       * vectorize). */
+      void randInts( uint32_t * out, std::size_t n ) {
+        static const std::size_t N = internal_state_length;
+        while ( n > 0u ) {
+          if ( left == 1 ) {
+            /* as in randInt(), except that left also counts the value that
+             * randInt() would have taken right away. */
+            next_state();
+            left = N + 1;
+          }
+
+          const std::size_t m = std::min( n, std::size_t(left - 1) );
+          for ( std::size_t i = 0u; i < m; ++i ) {
+            uint32_t y = next[i];
+            y ^= (y >> 11);
+            y ^= (y << 7) & 0x9d2c5680UL;
+            y ^= (y << 15) & 0xefc60000UL;
+            y ^= (y >> 18);
+            out[i] = y;
+          }
+
+          next += m;
+          left -= m;
+          out += m;
+          n -= m;
+        }
+      }
+
       /** Get the external representation of the current state vector. */
       StateVector getState() const {
         StateVector out_state;
@@ -259,6 +366,56 @@ namespace xylose {
         using std::copy;
         copy( s.val, s.val + internal_state_length, state.val );
         left = s[internal_state_length];
+        next = &state[0] + (internal_state_length + 1 - left);
+      }
+
+      /** Advance the generator by the number of steps of the jump
+       * polynomial.  This costs about as much as generating a few times
+       * 19937 numbers, independent of the size of the jump.  The position
+       * within the current block of the state is kept, so jump and randInt
+       * (or randInts) can be mixed freely. */
+      void jump( const JumpPolynomial & jp ) {
+        static const int N = internal_state_length;
+        const detail::gf2_polynomial & g = jp.get();
+
+        /* Horner's rule for g(T) applied to the state, where T shifts the
+         * window of N words by one word.  r is a circular buffer that starts
+         * at r[s]. */
+        std::vector<uint32_t> r( N, 0u );
+        int s = 0;
+        for ( int i = detail::degree(g); i >= 0; --i ) {
+          r[s] = r[(s+M) % N] ^ twist( r[s], r[(s+1) % N] );
+          s = (s+1) % N;
+
+          if ( detail::coefficient( g, i ) ) {
+            for ( int j = 0, k = s; j < N; ++j, k = (k+1 == N ? 0 : k+1) )
+              r[k] ^= state[j];
+          }
+        }
+
+        /* The lower bits of the first word do not take part in the
+         * recurrence (and g(T) is only exact modulo those bits), but that
+         * word is never output:  the next output is at least at offset 1. */
+        for ( int j = 0; j < N; ++j )
+          state[j] = r[(s+j) % N];
+        next = &state[0] + (N + 1 - left);
+      }
+
+      /** Advance the generator by 2^k steps.
+       * @see jump(const JumpPolynomial &). */
+      void jump( const unsigned int & k ) {
+        jump( JumpPolynomial::pow2(k) );
+      }
+
+      /** Split off a sub-stream.  The returned generator continues from the
+       * current position, while this generator jumps ahead by the size of
+       * the jump polynomial.  Repeated splits thus hand out consecutive
+       * non-overlapping blocks of the stream (e.g. one per thread) which
+       * are reproducible given the seed. */
+      MersenneTwister split( const JumpPolynomial & jp ) {
+        MersenneTwister retval( *this );
+        jump( jp );
+        return retval;
       }
 
     protected:
@@ -0,0 +1,247 @@
+/*==============================================================================
+ * Public Domain Contributions 2010 United States Government                   *
+ * as represented by the U.S. Air Force Research Laboratory.                   *
+ *                                                                             *
+ * This file is part of xylose                                                 *
+ *                                                                             *
+ * This program is free software: you can redistribute it and/or modify it     *
+ * under the terms of the GNU Lesser General Public License as published by    *
+ * the Free Software Foundation, either version 3 of the License, or (at your  *
+ * option) any later version.                                                  *
+ *                                                                             *
+ * This program is distributed in the hope that it will be useful, but WITHOUT *
+ * ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or       *
+ * FITNESS FOR A PARTICULAR PURPOSE.  See the GNU Lesser General Public        *
+ * License for more details.                                                   *
+ *                                                                             *
+ * You should have received a copy of the GNU Lesser General Public License    *
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.       *
+ *                                                                             *
+ -----------------------------------------------------------------------------*/
+
+
+#ifndef xylose_random_PCG64
+#define xylose_random_PCG64
+
+#include <xylose/random/detail/RandBase.hpp>
+#include <xylose/random/SplitMix64.hpp>
+#include <xylose/Vector.h>
+
+#include <boost/cstdint.hpp>
+
+namespace xylose {
+  namespace random {
+
+    using boost::uint64_t;
+
+    namespace detail {
+
+      /** Minimal unsigned 128 bit integer (modulo 2^128) for PCG64.  Uses the
+       * compiler's __uint128_t for the multiplication where available.
+       * The default constructor leaves the value uninitialized, as for the
+       * built-in integers. */
+      struct uint128 {
+        uint64_t hi, lo;
+
+        uint128() { }
+        uint128( const uint64_t & hi, const uint64_t & lo ) : hi(hi), lo(lo) { }
+
+        uint128 & operator+= ( const uint128 & that ) {
+          lo += that.lo;
+          hi += that.hi + ( lo < that.lo );
+          return *this;
+        }
+
+        uint128 operator* ( const uint128 & that ) const {
+          uint128 r = mul( lo, that.lo );
+          r.hi += hi * that.lo + lo * that.hi;
+          return r;
+        }
+
+        uint128 operator+ ( const uint128 & that ) const {
+          uint128 r = *this;
+          return r += that;
+        }
+
+        /** The full product of two 64 bit integers. */
+        static uint128 mul( const uint64_t & a, const uint64_t & b ) {
+        #if defined(__SIZEOF_INT128__)
+          const __uint128_t p = static_cast<__uint128_t>(a) * b;
+          return uint128( static_cast<uint64_t>( p >> 64u ),
+                          static_cast<uint64_t>( p ) );
+        #else
+          const uint64_t a0 = a & 0xffffffffu, a1 = a >> 32u;
+          const uint64_t b0 = b & 0xffffffffu, b1 = b >> 32u;
+          const uint64_t p00 = a0 * b0, p01 = a0 * b1;
+          const uint64_t p10 = a1 * b0, p11 = a1 * b1;
+          const uint64_t mid = ( p00 >> 32u ) + ( p01 & 0xffffffffu )
+                             + ( p10 & 0xffffffffu );
+          return uint128( p11 + ( p01 >> 32u ) + ( p10 >> 32u ) + ( mid >> 32u ),
+                          ( mid << 32u ) | ( p00 & 0xffffffffu ) );
+        #endif
+        }
+      };
+
+    }/* namespace xylose::random::detail */
+
+    /** PCG64 (pcg64 / pcg_setseq_128_xsl_rr_64) random number generator.
+     *
+     * A 128 bit linear congruential generator with a permuted output (the
+     * xor of the two halves of the state, rotated by its upper 6 bits),
+     * giving 64 bit output with a period of 2^128.  The increment selects
+     * one of 2^127 independent streams.  discard() jumps ahead in O(log n).
+     *
+     * randInt() gives the upper 32 bits of a 64 bit output.  seed(seed,
+     * stream) expands the 64 bit seed into the 128 bit initial state with
+     * SplitMix64; seed(initstate, initseq) is the seeding of the reference
+     * implementation.
+     *
+     * The algorithm is from M. E. O'Neill, "PCG: A family of simple fast
+     * space-efficient statistically good algorithms for random number
+     * generation", HMC-CS-2014-0905 (2014) and follows pcg64_random_r of
+     * the reference implementation.
+     */
+    class PCG64 : public detail::RandBase<PCG64> {
+      /* TYPEDEFS */
+    public:
+      /** Number of seed elements in SeedVector (64 bit seed and stream, lower
+       * word first). */
+      static const unsigned int seed_length = 4u;
+      /** Number of state elements in StateVector. */
+      static const unsigned int state_length = 8u;
+      /** SeedVector type. */
+      typedef xylose::Vector<uint32_t, seed_length> SeedVector;
+      /** StateVector type. */
+      typedef xylose::Vector<uint32_t, state_length> StateVector;
+      /** 128 bit integer type of the state. */
+      typedef detail::uint128 uint128;
+
+    protected:
+      typedef detail::RandBase<PCG64> super;
+
+      /* MEMBER STORAGE */
+      /** The LCG state. */
+      uint128 state;
+
+      /** The (odd) LCG increment that selects the stream. */
+      uint128 inc;
+
+    public:
+      /* MEMBER FUNCTIONS */
+      /** auto-initialize with /dev/urandom or time() and clock().  The
+       * seeding is done here rather than in RandBase(), since the members of
+       * PCG64 are not yet alive while the base is constructed. */
+      PCG64() : super(false) { super::seed(); }
+
+      /** Constructor with explicit seed and stream given. */
+      PCG64( const uint64_t & seed, const uint64_t & stream = 0u )
+        : super(false) {
+        this->seed(seed, stream);
+      }
+
+      /** Constructor with explicit vector seed value given. */
+      PCG64( const SeedVector & vseed ) : super(false) {
+        seed(vseed);
+      }
+
+      /** Constructor with explicit state given. */
+      PCG64( const StateVector & state ) : super(false) {
+        load(state);
+      }
+
+      /** (Re)seed the generator with the 128 bit initial state made from
+       * SplitMix64(seed). */
+      void seed( const uint64_t & seed, const uint64_t & stream = 0u ) {
+        SplitMix64 sm(seed);
+        const uint64_t hi = sm.randInt64();
+        const uint64_t lo = sm.randInt64();
+        this->seed( uint128(hi, lo), uint128(0u, stream) );
+      }
+
+      /** (Re)seed the generator from (seed, stream). */
+      void seed( const SeedVector & vseed ) {
+        seed( ( static_cast<uint64_t>(vseed[1]) << 32u ) | vseed[0],
+              ( static_cast<uint64_t>(vseed[3]) << 32u ) | vseed[2] );
+      }
+
+      /** (Re)seed the generator as pcg64_srandom_r of the reference
+       * implementation. */
+      void seed( const uint128 & initstate, const uint128 & initseq ) {
+        state = uint128(0u, 0u);
+        inc = uint128( ( initseq.hi << 1u ) | ( initseq.lo >> 63u ),
+                       ( initseq.lo << 1u ) | 1u );
+        step();
+        state += initstate;
+        step();
+      }
+
+      /** integer in [0,2^64 - 1]. */
+      uint64_t randInt64() {
+        step();
+        const uint64_t value = state.hi ^ state.lo;
+        const unsigned int rot = static_cast<unsigned int>( state.hi >> 58u );
+        return ( value >> rot ) | ( value << ( (64u - rot) & 63u ) );
+      }
+
+      /** integer in [0,2^32 - 1] (the upper half of randInt64()). */
+      uint32_t randInt() {
+        return static_cast<uint32_t>( randInt64() >> 32u );
+      }
+
+      /** Skip the next n values (in O(log n) steps). */
+      void discard( uint64_t n ) {
+        uint128 acc_mult(0u, 1u), acc_plus(0u, 0u);
+        uint128 cur_mult = multiplier(), cur_plus = inc;
+        for ( ; n > 0u; n >>= 1u ) {
+          if ( n & 1u ) {
+            acc_mult = acc_mult * cur_mult;
+            acc_plus = acc_plus * cur_mult + cur_plus;
+          }
+          cur_plus = ( cur_mult + uint128(0u, 1u) ) * cur_plus;
+          cur_mult = cur_mult * cur_mult;
+        }
+        state = acc_mult * state + acc_plus;
+      }
+
+      /** Get the StateVector (by value, since the state is kept as 128 bit
+       * integers). */
+      StateVector getState() const {
+        StateVector v;
+        save(v);
+        return v;
+      }
+
+      /** Save the StateVector to an external storage.  The elements are the
+       * state and then the increment, each lowest word first. */
+      void save( StateVector & v ) const {
+        const uint64_t w[4] = { state.lo, state.hi, inc.lo, inc.hi };
+        for ( int i = 0; i < 4; ++i ) {
+          v[2*i]   = static_cast<uint32_t>( w[i] );
+          v[2*i+1] = static_cast<uint32_t>( w[i] >> 32u );
+        }
+      }
+
+      /** Load the StateVector from an external storage. */
+      void load( const StateVector & v ) {
+        uint64_t w[4];
+        for ( int i = 0; i < 4; ++i )
+          w[i] = ( static_cast<uint64_t>(v[2*i+1]) << 32u ) | v[2*i];
+        state = uint128( w[1], w[0] );
+        inc = uint128( w[3], w[2] | 1u );
+      }
+
+    private:
+      static uint128 multiplier() {
+        return uint128( UINT64_C(2549297995355413076),
+                        UINT64_C(4865540595714422341) );
+      }
+
+      void step() {
+        state = state * multiplier() + inc;
+      }
+    };
+
+  }/* namespace xylose::random */
+}/* namespace xylose */
+
+#endif // xylose_random_PCG64
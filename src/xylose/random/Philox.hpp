@@ -0,0 +1,240 @@
+/*==============================================================================
+ * Public Domain Contributions 2010 United States Government                   *
+ * as represented by the U.S. Air Force Research Laboratory.                   *
+ *                                                                             *
+ * This file is part of xylose                                                 *
+ *                                                                             *
+ * This program is free software: you can redistribute it and/or modify it     *
+ * under the terms of the GNU Lesser General Public License as published by    *
+ * the Free Software Foundation, either version 3 of the License, or (at your  *
+ * option) any later version.                                                  *
+ *                                                                             *
+ * This program is distributed in the hope that it will be useful, but WITHOUT *
+ * ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or       *
+ * FITNESS FOR A PARTICULAR PURPOSE.  See the GNU Lesser General Public        *
+ * License for more details.                                                   *
+ *                                                                             *
+ * You should have received a copy of the GNU Lesser General Public License    *
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.       *
+ *                                                                             *
+ -----------------------------------------------------------------------------*/
+
+
+#ifndef xylose_random_Philox
+#define xylose_random_Philox
+
+#include <xylose/random/detail/RandBase.hpp>
+#include <xylose/Vector.h>
+
+#include <boost/cstdint.hpp>
+
+#include <cstddef>
+
+namespace xylose {
+  namespace random {
+
+    using boost::uint64_t;
+
+    /** Counter-based Philox4x32-10 random number generator.
+     *
+     * Philox is a keyed bijection of a 128 bit counter (ten rounds of
+     * multiply/xor/key-bump on four 32 bit words).  Each value of the counter
+     * gives four independent 32 bit numbers.  Here the 64 bit key is made
+     * from (seed, stream) and the lower 64 bits of the counter are the block
+     * index in the stream, so that:
+     * - generators with different (seed, stream) are independent, without
+     *   any seeding or skip-ahead (e.g. one stream per thread or per
+     *   particle);
+     * - any position of a stream can be reached in \f$ O(1) \f$ (see seek);
+     * - the state is only a few words, so that generators are cheap to make
+     *   and copy.
+     * .
+     * Results are therefore bitwise reproducible independent of how work is
+     * distributed over threads, as long as each unit of work draws from its
+     * own stream.
+     *
+     * The algorithm is from J. K. Salmon, M. A. Moraes, R. O. Dror and D. E.
+     * Shaw, "Parallel random numbers: as easy as 1, 2, 3", SC11 (2011); the
+     * output matches the known-answer vectors of their Random123 library.
+     */
+    class Philox : public detail::RandBase<Philox> {
+      /* TYPEDEFS */
+    public:
+      /** Number of seed elements in SeedVector (seed, stream). */
+      static const unsigned int seed_length = 2u;
+      /** Number of state elements in StateVector. */
+      static const unsigned int state_length = 7u;
+      /** SeedVector type. */
+      typedef xylose::Vector<uint32_t, seed_length> SeedVector;
+      /** StateVector type. */
+      typedef xylose::Vector<uint32_t, state_length> StateVector;
+
+    protected:
+      typedef detail::RandBase<Philox> super;
+
+      /* MEMBER STORAGE */
+      /** State vector.
+       * The elements are:
+       * - state[0..3] : counter of the next block (lowest word first)
+       * - state[4]    : key[0] (seed)
+       * - state[5]    : key[1] (stream)
+       * - state[6]    : number of values of the current block that have
+       *                 already been used (4 if none remain)
+       * .
+       */
+      StateVector state;
+
+      /** The current block of output. */
+      uint32_t block[4];
+
+    public:
+      /* MEMBER FUNCTIONS */
+      /** auto-initialize with /dev/urandom or time() and clock().  The
+       * seeding is done here rather than in RandBase(), since the members of
+       * Philox are not yet alive while the base is constructed. */
+      Philox() : super(false) { super::seed(); }
+
+      /** Constructor with explicit seed and stream given. */
+      Philox( const uint32_t & seed, const uint32_t & stream = 0u )
+        : super(false) {
+        this->seed(seed, stream);
+      }
+
+      /** Constructor with explicit vector seed value given. */
+      Philox( const SeedVector & vseed ) : super(false) {
+        seed(vseed);
+      }
+
+      /** Constructor with explicit state given. */
+      Philox( const StateVector & state ) : super(false) {
+        load(state);
+      }
+
+      /** (Re)seed the generator and rewind to the start of the stream. */
+      void seed( const uint32_t & seed, const uint32_t & stream = 0u ) {
+        state[4] = seed;
+        state[5] = stream;
+        seek(0u);
+      }
+
+      /** (Re)seed the generator from (seed, stream). */
+      void seed( const SeedVector & vseed ) {
+        seed( vseed[0], vseed[1] );
+      }
+
+      /** Position the generator at the nth value of the stream. */
+      void seek( const uint64_t & n ) {
+        const uint64_t b = n >> 2u;
+        state[0] = static_cast<uint32_t>( b );
+        state[1] = static_cast<uint32_t>( b >> 32u );
+        state[2] = state[3] = 0u;
+        state[6] = 4u;
+        const uint32_t used = static_cast<uint32_t>( n & 3u );
+        if ( used ) {
+          refill();
+          state[6] = used;
+        }
+      }
+
+      /** Skip the next n values. */
+      void discard( const uint64_t & n ) {
+        seek( tell() + n );
+      }
+
+      /** Number of values of the stream that have been used. */
+      uint64_t tell() const {
+        const uint64_t b = ( static_cast<uint64_t>(state[1]) << 32u )
+                         | state[0];
+        /* the counter already points beyond a partially used block. */
+        return state[6] == 4u ? 4u * b : 4u * (b - 1u) + state[6];
+      }
+
+      /** integer in [0,2^32 - 1]. */
+      uint32_t randInt() {
+        if ( state[6] == 4u )
+          refill();
+        return block[ state[6]++ ];
+      }
+
+      /** Store n numbers on [0,2^32 - 1] in out.  Gives the same numbers as
+       * n calls to randInt(); whole blocks are written directly to out. */
+      void randInts( uint32_t * out, std::size_t n ) {
+        for ( ; n > 0u && state[6] < 4u; --n )
+          *out++ = block[ state[6]++ ];
+
+        for ( ; n >= 4u; n -= 4u, out += 4 ) {
+          bijection( &state[0], &state[4], out );
+          for ( int i = 0; i < 4 && ++state[i] == 0u; ++i );
+        }
+
+        for ( ; n > 0u; --n )
+          *out++ = randInt();
+      }
+
+      /** Get a const reference to the StateVector. */
+      const StateVector & getState() const {
+        return state;
+      }
+
+      /** Save the StateVector to an external storage. */
+      void save( StateVector & s ) const {
+        s = state;
+      }
+
+      /** Load the StateVector from an external storage. */
+      void load( const StateVector & s ) {
+        state = s;
+        if ( state[6] < 4u ) {
+          /* regenerate the partially used block. */
+          const uint32_t used = state[6];
+          decrement();
+          refill();
+          state[6] = used;
+        }
+      }
+
+      /** The Philox4x32-10 bijection:  out = Philox_key(ctr). */
+      static void bijection( const uint32_t ctr[4], const uint32_t key[2],
+                             uint32_t out[4] ) {
+        const uint32_t M0 = 0xD2511F53u, M1 = 0xCD9E8D57u;
+        const uint32_t W0 = 0x9E3779B9u, W1 = 0xBB67AE85u;
+
+        uint32_t c0 = ctr[0], c1 = ctr[1], c2 = ctr[2], c3 = ctr[3];
+        uint32_t k0 = key[0], k1 = key[1];
+        for ( int r = 0; r < 10; ++r ) {
+          const uint64_t p0 = static_cast<uint64_t>(M0) * c0;
+          const uint64_t p1 = static_cast<uint64_t>(M1) * c2;
+          const uint32_t hi0 = static_cast<uint32_t>( p0 >> 32u );
+          const uint32_t hi1 = static_cast<uint32_t>( p1 >> 32u );
+          c0 = hi1 ^ c1 ^ k0;
+          c1 = static_cast<uint32_t>( p1 );
+          c2 = hi0 ^ c3 ^ k1;
+          c3 = static_cast<uint32_t>( p0 );
+          k0 += W0;
+          k1 += W1;
+        }
+
+        out[0] = c0;
+        out[1] = c1;
+        out[2] = c2;
+        out[3] = c3;
+      }
+
+    private:
+      /** Generate the block of the current counter and increment it. */
+      void refill() {
+        bijection( &state[0], &state[4], block );
+        state[6] = 0u;
+        for ( int i = 0; i < 4 && ++state[i] == 0u; ++i );
+      }
+
+      /** Decrement the counter. */
+      void decrement() {
+        for ( int i = 0; i < 4 && state[i]-- == 0u; ++i );
+      }
+    };
+
+  }/* namespace xylose::random */
+}/* namespace xylose */
+
+#endif // xylose_random_Philox
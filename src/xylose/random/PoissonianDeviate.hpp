@@ -31,15 +31,130 @@
 #define xylose_random_PoissonianDeviate_h
 
 #include <xylose/random/Kiss.hpp>
+#include <xylose/random/ThreadRNG.hpp>
 #include <xylose/compat/math.hpp>
 
 #include <limits>
+#include <vector>
+#include <cmath>
+#include <cstddef>
+#include <algorithm>
 
 
 namespace xylose {
   namespace random {
 
+    namespace detail {
 
+      /** Poisson distribution computed by the PTRS algorithm.  The constants
+       * that only depend on lambda are computed by the constructor, so that
+       * an instance may be kept for repeated draws with the same lambda (see
+       * PoissonianSampler).
+       * @see Hoermann, W. The Transformed Rejection Method for Generating Poisson
+       * Random Variables. Insurance: Mathematics and Economics, (to appear).
+       * http://citeseer.csail.mit.edu/151115.html
+       */
+      struct PoissonPTRS {
+        /* MEMBER STORAGE */
+        double lam, loglam, a, b, ln_invalpha, vr;
+
+        /* MEMBER FUNCTIONS */
+        PoissonPTRS( const double & lam ) : lam(lam) {
+          using std::log;
+          using std::sqrt;
+
+          loglam = log(lam);
+          b = 0.931 + 2.53 * sqrt(lam);
+          a = -0.059 + 0.02483 * b;
+          ln_invalpha = log( 1.1239 + 1.1328/(b-3.4) );
+          vr = 0.9277 - 3.6224/(b-2);
+        }
+
+        template < typename RNG >
+        unsigned long long operator() ( RNG & rng ) const {
+          using std::log;
+          using ::lgamma;
+
+          while (true) {
+            double U = rng.rand() - 0.5;
+            double V = rng.rand();
+            double us = 0.5 - std::abs(U);
+            unsigned long long retval
+              = static_cast<unsigned long long>( (2*a/us + b)*U + lam + 0.43 );
+
+            if ((us >= 0.07) && (V <= vr))
+              return retval;
+
+            if ((retval < 0) || ((us < 0.013) && (V > us)))
+              continue;
+
+            if ((log(V) + ln_invalpha - log(a/(us*us)+b)) <=
+                (-lam + retval*loglam - lgamma(retval+1)))
+              return retval;
+          }
+        }
+      };
+
+      /** Poisson distribution by inversion of a tabulated cumulative
+       * distribution.  The search for the inverse starts from a guide table
+       * (Chen and Asau, 1974) so that a draw costs one uniform variate and,
+       * on average, less than two comparisons.
+       *
+       * The table ends where the remaining probability is below 1e-17 of the
+       * total; this remainder is assigned to the last entry.  This is only
+       * intended for small lambda (the table has O(lambda) entries).
+       */
+      struct PoissonTable {
+        /* MEMBER STORAGE */
+        /** cdf[k] = P(X <= k). */
+        std::vector<double> cdf;
+
+        /** guide[j] = the smallest k with cdf[k] > j / guide.size(). */
+        std::vector<unsigned int> guide;
+
+        /* MEMBER FUNCTIONS */
+        PoissonTable( const double & lam ) {
+          double p = std::exp(-lam);
+          double c = p;
+          cdf.push_back(c);
+          for ( unsigned int k = 1u; p > 1e-17 * c || k <= lam; ++k ) {
+            p *= lam / k;
+            c += p;
+            cdf.push_back(c);
+          }
+          cdf.back() = 1.0;
+
+          guide.resize( cdf.size() );
+          unsigned int k = 0u;
+          for ( unsigned int j = 0u; j < guide.size(); ++j ) {
+            const double u = double(j) / guide.size();
+            while ( cdf[k] <= u )
+              ++k;
+            guide[j] = k;
+          }
+        }
+
+        /** The inverse of the cumulative distribution at u in [0,1). */
+        unsigned long long operator() ( const double & u ) const {
+          unsigned int k = guide[ static_cast<unsigned int>( u * guide.size() ) ];
+          while ( cdf[k] <= u )
+            ++k;
+          return k;
+        }
+      };
+
+    }/* namespace xylose::random::detail */
+
+
+    /** Poisson deviate for a lambda that may change with every draw.
+     *
+     * Note that the former public members <code>RNG & rng</code> and
+     * <code>static RNG global_rng</code> were removed in favor of the per
+     * thread generators of ThreadRNG:  use getRNG() instead of rng, and
+     * ThreadRNG<RNG>::per_thread() (or pass a generator to the constructor)
+     * instead of global_rng.
+     * @see PoissonianSampler for drawing many values for the same lambda.
+     */
     template < typename RNG = xylose::random::Kiss >
     class PoissonianDeviate {
       /* TYPEDEFS */
@@ -66,39 +181,10 @@ namespace xylose {
       };
 
       /** Poisson distribution computer by the PTRS algorithm.
-       * @see Hoermann, W. The Transformed Rejection Method for Generating Poisson
-       * Random Variables. Insurance: Mathematics and Economics, (to appear).
-       * http://citeseer.csail.mit.edu/151115.html
-       */
+       * @see detail::PoissonPTRS. */
       struct PoissonPTRS {
         unsigned long long operator() ( const double & lam, RNG & rng ) const {
-          using std::log;
-          using std::sqrt;
-          using ::lgamma;
-
-          double loglam = log(lam);
-          double b = 0.931 + 2.53 * sqrt(lam);
-          double a = -0.059 + 0.02483 * b;
-          double ln_invalpha = log( 1.1239 + 1.1328/(b-3.4) );
-          double vr = 0.9277 - 3.6224/(b-2);
-
-          while (true) {
-            double U = rng.rand() - 0.5;
-            double V = rng.rand();
-            double us = 0.5 - std::abs(U);
-            unsigned long long retval
-              = static_cast<unsigned long long>( (2*a/us + b)*U + lam + 0.43 );
-
-            if ((us >= 0.07) && (V <= vr))
-              return retval;
-
-            if ((retval < 0) || ((us < 0.013) && (V > us)))
-              continue;
-
-            if ((log(V) + ln_invalpha - log(a/(us*us)+b)) <=
-                (-lam + retval*loglam - lgamma(retval+1)))
-              return retval;
-          }
+          return detail::PoissonPTRS(lam)(rng);
         }
       };
 
@@ -108,15 +194,13 @@ namespace xylose {
       PoissonMult mult;
       PoissonPTRS ptrs;
 
-    public:
-      /** Reference to the random number generator. */
-      RNG & rng;
+      /** The random number generator (NULL for the generator of the calling
+       * thread). */
+      RNG * rng;
 
 
       /* STATIC STORAGE */
     public:
-      static RNG global_rng;
-
       static inline const double & lambda_max() {
         static const double value =
             std::numeric_limits<unsigned long long>::max() -
@@ -127,17 +211,29 @@ namespace xylose {
 
       /* MEMBER FUNCTIONS */
     public:
-      PoissonianDeviate( RNG & rng = global_rng )
-        : rng(rng) { }
+      /** Constructor.
+       * @param rng
+       *    The random number generator to use [default:  the generator of
+       *    the thread that draws, see ThreadRNG].
+       */
+      PoissonianDeviate( RNG & rng = ThreadRNG<RNG>::per_thread() )
+        : rng( ThreadRNG<RNG>::bind(rng) ) { }
+
+      /** The random number generator used by this deviate. */
+      RNG & getRNG() const {
+        return ThreadRNG<RNG>::select(rng);
+      }
 
       /* Poisson distribution with mean=lam.
        * When lam < 10, a basic algorithm using repeated multiplications of uniform
        * variates is used (Devroye p. 504).
        * When lam >= 10, algorithm PTRS from (Hoermann 1992) is used.
+       * For many draws with the same lam, PoissonianSampler avoids redoing
+       * the setup of each draw.
        */
       unsigned long long operator() ( const double & lam ) const {
         if      (lam < 10.0)
-          return mult(lam, rng);
+          return mult(lam, getRNG());
         else if (lam <= 0.0)
           return 0u;
         else if (lam > lambda_max() )
@@ -145,13 +241,113 @@ namespace xylose {
            * distribution in the dynamic range of the unsigned long long. */
           return static_cast<unsigned long long>(lam);
         else
-          return ptrs(lam, rng);
+          return ptrs(lam, getRNG());
       }
 
     };
 
-    template < typename RNG >
-    RNG PoissonianDeviate<RNG>::global_rng;
+
+    /** Poisson deviates for a fixed mean.
+     *
+     * Where PoissonianDeviate takes lambda with each draw, this does all the
+     * work that only depends on lambda once in the constructor:
+     *    - lambda < 10:  a table of the cumulative distribution is inverted
+     *      with one uniform variate per draw (see detail::PoissonTable),
+     *    - lambda >= 10:  the constants of the PTRS algorithm are kept, which
+     *      leaves the transcendental functions to the draws that are not
+     *      accepted by the squeeze of PTRS.
+     *
+     * Keep one instance per value of lambda that is drawn from repeatedly
+     * (e.g. per collision cell type).
+     */
+    template < typename RNG = xylose::random::Kiss >
+    class PoissonianSampler {
+      /* MEMBER STORAGE */
+    private:
+      /** The mean. */
+      double lam;
+
+      /** Inverse-cdf table (used if lam < 10). */
+      detail::PoissonTable table;
+
+      /** PTRS constants (used if lam >= 10). */
+      detail::PoissonPTRS ptrs;
+
+      /** The random number generator (NULL for the generator of the calling
+       * thread). */
+      RNG * rng;
+
+
+      /* MEMBER FUNCTIONS */
+    public:
+      /** Constructor.
+       * @param lam
+       *    The mean of the distribution.
+       * @param rng
+       *    The random number generator to use [default:  the generator of
+       *    the thread that draws, see ThreadRNG].
+       */
+      PoissonianSampler( const double & lam,
+                         RNG & rng = ThreadRNG<RNG>::per_thread() )
+        : lam( std::max(lam, 0.0) ),
+          table( lam < 10.0 ? std::max(lam, 0.0) : 0.0 ),
+          ptrs( lam < 10.0 ? 10.0 : lam ),
+          rng( ThreadRNG<RNG>::bind(rng) ) { }
+
+      /** The mean of the distribution. */
+      const double & getLambda() const { return lam; }
+
+      /** The random number generator used by this sampler. */
+      RNG & getRNG() const {
+        return ThreadRNG<RNG>::select(rng);
+      }
+
+      /** A Poisson deviate with mean getLambda(). */
+      unsigned long long operator() () const {
+        if      (lam < 10.0)
+          return table( getRNG().randExc() );
+        else if (lam > PoissonianDeviate<RNG>::lambda_max() )
+          return static_cast<unsigned long long>(lam);
+        else
+          return ptrs( getRNG() );
+      }
+
+      /** Store n Poisson deviates at out.  For lam < 10 the uniform variates
+       * are drawn in blocks (see RandBase::randInts) and give the same
+       * numbers as n single calls.
+       * @return the end of the output.
+       */
+      template < typename OutputIterator >
+      OutputIterator generate_n( OutputIterator out, std::size_t n ) const {
+        RNG & g = getRNG();
+        if ( lam < 10.0 ) {
+          const double scale = 1. / (static_cast<double>(RNG::rand_max) + 1.);
+          const std::size_t block = 256u;
+          uint32_t buf[block];
+          while ( n > 0u ) {
+            const std::size_t m = std::min( n, block );
+            g.randInts( buf, m );
+            for ( std::size_t k = 0u; k < m; ++k, ++out )
+              *out = table( buf[k] * scale );
+            n -= m;
+          }
+        } else if ( lam > PoissonianDeviate<RNG>::lambda_max() ) {
+          const unsigned long long k = static_cast<unsigned long long>(lam);
+          for ( ; n > 0u; --n, ++out )
+            *out = k;
+        } else {
+          for ( ; n > 0u; --n, ++out )
+            *out = ptrs( g );
+        }
+        return out;
+      }
+
+      /** Fill [first,last) with Poisson deviates.  @see generate_n. */
+      template < typename ForwardIterator >
+      void fill( ForwardIterator first, ForwardIterator last ) const {
+        generate_n( first, std::distance( first, last ) );
+      }
+    };
 
   }/* namespace xylose::random */
 }/* namespace xylose */
@@ -0,0 +1,134 @@
+/*==============================================================================
+ * Public Domain Contributions 2010 United States Government                   *
+ * as represented by the U.S. Air Force Research Laboratory.                   *
+ *                                                                             *
+ * This file is part of xylose                                                 *
+ *                                                                             *
+ * This program is free software: you can redistribute it and/or modify it     *
+ * under the terms of the GNU Lesser General Public License as published by    *
+ * the Free Software Foundation, either version 3 of the License, or (at your  *
+ * option) any later version.                                                  *
+ *                                                                             *
+ * This program is distributed in the hope that it will be useful, but WITHOUT *
+ * ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or       *
+ * FITNESS FOR A PARTICULAR PURPOSE.  See the GNU Lesser General Public        *
+ * License for more details.                                                   *
+ *                                                                             *
+ * You should have received a copy of the GNU Lesser General Public License    *
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.       *
+ *                                                                             *
+ -----------------------------------------------------------------------------*/
+
+
+#ifndef xylose_random_SplitMix64
+#define xylose_random_SplitMix64
+
+#include <xylose/random/detail/RandBase.hpp>
+#include <xylose/Vector.h>
+
+#include <boost/cstdint.hpp>
+
+namespace xylose {
+  namespace random {
+
+    using boost::uint64_t;
+
+    /** SplitMix64 random number generator.
+     *
+     * A Weyl sequence (the state is incremented by the golden ratio) passed
+     * through a 64 bit mixing function.  Any seed, including zero, gives a
+     * good sequence, which makes this the standard way to expand a single 64
+     * bit seed into the larger state of other generators (see Xoshiro256ss
+     * and PCG64).  It is also a fast generator by itself, although with a
+     * period of only 2^64.
+     *
+     * randInt() gives the upper 32 bits of a 64 bit output; randInt64() and
+     * the rand*53() functions use all of it.
+     *
+     * The algorithm is from S. Vigna's reference implementation (after G. L.
+     * Steele, D. Lea and C. H. Flood, "Fast splittable pseudorandom number
+     * generators", OOPSLA 2014).
+     */
+    class SplitMix64 : public detail::RandBase<SplitMix64> {
+      /* TYPEDEFS */
+    public:
+      /** Number of seed elements in SeedVector (lower word first). */
+      static const unsigned int seed_length = 2u;
+      /** Number of state elements in StateVector (lower word first). */
+      static const unsigned int state_length = 2u;
+      /** SeedVector type. */
+      typedef xylose::Vector<uint32_t, seed_length> SeedVector;
+      /** StateVector type. */
+      typedef xylose::Vector<uint32_t, state_length> StateVector;
+
+    protected:
+      typedef detail::RandBase<SplitMix64> super;
+
+      /* MEMBER STORAGE */
+      /** The state. */
+      uint64_t x;
+
+    public:
+      /* MEMBER FUNCTIONS */
+      /** auto-initialize with /dev/urandom or time() and clock().  The
+       * seeding is done here rather than in RandBase(), since the members of
+       * SplitMix64 are not yet alive while the base is constructed. */
+      SplitMix64() : super(false) { super::seed(); }
+
+      /** Constructor with explicit seed value given. */
+      SplitMix64( const uint64_t & seed ) : super(false) {
+        this->seed(seed);
+      }
+
+      /** Constructor with explicit vector seed value given. */
+      SplitMix64( const SeedVector & vseed ) : super(false) {
+        seed(vseed);
+      }
+
+      /** (Re)seed the generator. */
+      void seed( const uint64_t & seed ) {
+        x = seed;
+      }
+
+      /** (Re)seed the generator. */
+      void seed( const SeedVector & vseed ) {
+        seed( ( static_cast<uint64_t>(vseed[1]) << 32u ) | vseed[0] );
+      }
+
+      /** integer in [0,2^64 - 1]. */
+      uint64_t randInt64() {
+        uint64_t z = ( x += UINT64_C(0x9e3779b97f4a7c15) );
+        z = ( z ^ (z >> 30u) ) * UINT64_C(0xbf58476d1ce4e5b9);
+        z = ( z ^ (z >> 27u) ) * UINT64_C(0x94d049bb133111eb);
+        return z ^ (z >> 31u);
+      }
+
+      /** integer in [0,2^32 - 1] (the upper half of randInt64()). */
+      uint32_t randInt() {
+        return static_cast<uint32_t>( randInt64() >> 32u );
+      }
+
+      /** Get the StateVector (by value, since the state is kept as a 64 bit
+       * integer). */
+      StateVector getState() const {
+        StateVector s;
+        save(s);
+        return s;
+      }
+
+      /** Save the StateVector to an external storage. */
+      void save( StateVector & s ) const {
+        s[0] = static_cast<uint32_t>( x );
+        s[1] = static_cast<uint32_t>( x >> 32u );
+      }
+
+      /** Load the StateVector from an external storage. */
+      void load( const StateVector & s ) {
+        x = ( static_cast<uint64_t>(s[1]) << 32u ) | s[0];
+      }
+    };
+
+  }/* namespace xylose::random */
+}/* namespace xylose */
+
+#endif // xylose_random_SplitMix64
@@ -0,0 +1,189 @@
+/*==============================================================================
+ * Public Domain Contributions 2010 United States Government                   *
+ * as represented by the U.S. Air Force Research Laboratory.                   *
+ *                                                                             *
+ * This file is part of xylose                                                 *
+ *                                                                             *
+ * This program is free software: you can redistribute it and/or modify it     *
+ * under the terms of the GNU Lesser General Public License as published by    *
+ * the Free Software Foundation, either version 3 of the License, or (at your  *
+ * option) any later version.                                                  *
+ *                                                                             *
+ * This program is distributed in the hope that it will be useful, but WITHOUT *
+ * ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or       *
+ * FITNESS FOR A PARTICULAR PURPOSE.  See the GNU Lesser General Public        *
+ * License for more details.                                                   *
+ *                                                                             *
+ * You should have received a copy of the GNU Lesser General Public License    *
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.       *
+ *                                                                             *
+ -----------------------------------------------------------------------------*/
+
+
+#ifndef xylose_random_ThreadRNG
+#define xylose_random_ThreadRNG
+
+#include <xylose/random/Kiss.hpp>
+#include <xylose/random/Philox.hpp>
+#include <xylose/Vector.h>
+
+#include <pthread.h>
+
+namespace xylose {
+  namespace random {
+
+    /** Registry of one generator per thread.
+     *
+     * Each thread that calls get() receives its own generator, so sampling
+     * from several threads needs no locking and does not contend.  The
+     * generator of a thread is made on first use and deleted when the thread
+     * exits.  It is seeded deterministically from (master seed, thread
+     * index), where
+     * - the master seed is set by seed() [default:  from /dev/urandom (or
+     *   time() and clock()) once per process];
+     * - the thread index is given by setThreadIndex() or otherwise assigned
+     *   in the order in which threads first call get().
+     * .
+     * The seed vector of each generator is taken from the Philox stream
+     * (master seed, thread index), so the generators of different threads are
+     * seeded independently.  Runs are reproducible when the master seed is
+     * set and the work done by each thread index is fixed.
+     *
+     * Samplers (Inverter, DiscreteInverter, GaussianDeviate, ...) use the
+     * generator of the calling thread when they are given per_thread()
+     * (which is their default) instead of a specific generator.
+     *
+     * @tparam RNG
+     *    The type of generator [default xylose::random::Kiss].
+     */
+    template < typename RNG = xylose::random::Kiss >
+    class ThreadRNG {
+      /* TYPEDEFS */
+    private:
+      /** Thread-local storage of a thread. */
+      struct Slot {
+        int index;
+        unsigned int generation;
+        RNG rng;
+
+        Slot( const int & index, const unsigned int & generation )
+          : index(index), generation(generation), rng(0u) { }
+      };
+
+      /** Process wide state of the registry. */
+      struct Registry {
+        pthread_key_t key;
+        pthread_mutex_t mutex;
+        uint32_t master_seed;
+        unsigned int generation;
+        int next_index;
+
+        Registry() : generation(0u), next_index(0) {
+          pthread_key_create( &key, &deleteSlot );
+          pthread_mutex_init( &mutex, NULL );
+          Kiss k;
+          master_seed = k.randInt();
+        }
+      };
+
+
+      /* MEMBER FUNCTIONS */
+    public:
+      /** The generator of the calling thread. */
+      static RNG & get() {
+        Registry & r = registry();
+        Slot * s = static_cast<Slot*>( pthread_getspecific( r.key ) );
+        if ( !s ) {
+          pthread_mutex_lock( &r.mutex );
+          s = new Slot( r.next_index++, r.generation );
+          pthread_mutex_unlock( &r.mutex );
+          seedSlot( *s, r.master_seed );
+          pthread_setspecific( r.key, s );
+        } else if ( s->generation != r.generation ) {
+          s->generation = r.generation;
+          seedSlot( *s, r.master_seed );
+        }
+        return s->rng;
+      }
+
+      /** The index of the calling thread. */
+      static int getThreadIndex() {
+        get();
+        Registry & r = registry();
+        return static_cast<Slot*>( pthread_getspecific( r.key ) )->index;
+      }
+
+      /** Set the index of the calling thread and reseed its generator
+       * accordingly. */
+      static void setThreadIndex( const int & index ) {
+        get();
+        Registry & r = registry();
+        Slot * s = static_cast<Slot*>( pthread_getspecific( r.key ) );
+        s->index = index;
+        seedSlot( *s, r.master_seed );
+      }
+
+      /** Set the master seed.  Generators of all threads are reseeded (on
+       * their next use) from the new master seed and their thread index.
+       * This should be called while no other thread is drawing numbers (e.g.
+       * before tasks are handed to a PThreadCache).
+       */
+      static void seed( const uint32_t & master_seed ) {
+        Registry & r = registry();
+        pthread_mutex_lock( &r.mutex );
+        r.master_seed = master_seed;
+        ++r.generation;
+        pthread_mutex_unlock( &r.mutex );
+      }
+
+      /** The master seed. */
+      static uint32_t getMasterSeed() {
+        return registry().master_seed;
+      }
+
+      /** Marker for "the generator of the calling thread".  Samplers that
+       * are given this generator look up the generator of the calling thread
+       * at each draw.  The marker itself is never used to generate
+       * numbers. */
+      static RNG & per_thread() {
+        static RNG marker( 0u );
+        return marker;
+      }
+
+      /** Pointer to store for a generator given to a sampler:  NULL for
+       * per_thread(), otherwise the address of rng. */
+      static RNG * bind( RNG & rng ) {
+        return &rng == &per_thread() ? NULL : &rng;
+      }
+
+      /** The generator to draw from for a pointer given by bind(). */
+      static RNG & select( RNG * rng ) {
+        return rng ? *rng : get();
+      }
+
+    private:
+      /** The registry (made on first use). */
+      static Registry & registry() {
+        static Registry r;
+        return r;
+      }
+
+      /** Seed the generator of s from (master seed, thread index). */
+      static void seedSlot( Slot & s, const uint32_t & master_seed ) {
+        Philox p( master_seed, static_cast<uint32_t>( s.index ) );
+        xylose::Vector<uint32_t, RNG::seed_length> v;
+        for ( unsigned int i = 0u; i < RNG::seed_length; ++i )
+          v[i] = p.randInt();
+        s.rng.seed( v );
+      }
+
+      /** Deletes the slot of an exiting thread. */
+      static void deleteSlot( void * s ) {
+        delete static_cast<Slot*>( s );
+      }
+    };
+
+  }/* namespace xylose::random */
+}/* namespace xylose */
+
+#endif // xylose_random_ThreadRNG
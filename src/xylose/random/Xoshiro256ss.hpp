@@ -0,0 +1,194 @@
+/*==============================================================================
+ * Public Domain Contributions 2010 United States Government                   *
+ * as represented by the U.S. Air Force Research Laboratory.                   *
+ *                                                                             *
+ * This file is part of xylose                                                 *
+ *                                                                             *
+ * This program is free software: you can redistribute it and/or modify it     *
+ * under the terms of the GNU Lesser General Public License as published by    *
+ * the Free Software Foundation, either version 3 of the License, or (at your  *
+ * option) any later version.                                                  *
+ *                                                                             *
+ * This program is distributed in the hope that it will be useful, but WITHOUT *
+ * ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or       *
+ * FITNESS FOR A PARTICULAR PURPOSE.  See the GNU Lesser General Public        *
+ * License for more details.                                                   *
+ *                                                                             *
+ * You should have received a copy of the GNU Lesser General Public License    *
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.       *
+ *                                                                             *
+ -----------------------------------------------------------------------------*/
+
+
+#ifndef xylose_random_Xoshiro256ss
+#define xylose_random_Xoshiro256ss
+
+#include <xylose/random/detail/RandBase.hpp>
+#include <xylose/random/SplitMix64.hpp>
+#include <xylose/Vector.h>
+
+#include <boost/cstdint.hpp>
+
+namespace xylose {
+  namespace random {
+
+    using boost::uint64_t;
+
+    /** xoshiro256** random number generator.
+     *
+     * A 256 bit xor/shift/rotate linear engine with a multiplicative
+     * scrambler, giving 64 bit output with a period of 2^256 - 1.  It passes
+     * the BigCrush and PractRand batteries and needs a handful of
+     * instructions per 64 bit number, so that a 53 bit double (rand53() etc.)
+     * costs a single step.
+     *
+     * randInt() gives the upper 32 bits of a 64 bit output.  The seed is
+     * expanded into the state with SplitMix64 as recommended by the authors.
+     * jump() and long_jump() advance the generator by 2^128 and 2^192 steps
+     * to give non-overlapping sequences for parallel use.
+     *
+     * The algorithm is from D. Blackman and S. Vigna, "Scrambled linear
+     * pseudorandom number generators", ACM Trans. Math. Softw. 47 (2021).
+     */
+    class Xoshiro256ss : public detail::RandBase<Xoshiro256ss> {
+      /* TYPEDEFS */
+    public:
+      /** Number of seed elements in SeedVector (a 64 bit seed, lower word
+       * first). */
+      static const unsigned int seed_length = 2u;
+      /** Number of state elements in StateVector. */
+      static const unsigned int state_length = 8u;
+      /** SeedVector type. */
+      typedef xylose::Vector<uint32_t, seed_length> SeedVector;
+      /** StateVector type. */
+      typedef xylose::Vector<uint32_t, state_length> StateVector;
+
+    protected:
+      typedef detail::RandBase<Xoshiro256ss> super;
+
+      /* MEMBER STORAGE */
+      /** The state. */
+      uint64_t s[4];
+
+    public:
+      /* MEMBER FUNCTIONS */
+      /** auto-initialize with /dev/urandom or time() and clock().  The
+       * seeding is done here rather than in RandBase(), since the members of
+       * Xoshiro256ss are not yet alive while the base is constructed. */
+      Xoshiro256ss() : super(false) { super::seed(); }
+
+      /** Constructor with explicit seed value given. */
+      Xoshiro256ss( const uint64_t & seed ) : super(false) {
+        this->seed(seed);
+      }
+
+      /** Constructor with explicit vector seed value given. */
+      Xoshiro256ss( const SeedVector & vseed ) : super(false) {
+        seed(vseed);
+      }
+
+      /** Constructor with explicit state given. */
+      Xoshiro256ss( const StateVector & state ) : super(false) {
+        load(state);
+      }
+
+      /** (Re)seed the generator:  the state is the first four outputs of
+       * SplitMix64(seed). */
+      void seed( const uint64_t & seed ) {
+        SplitMix64 sm(seed);
+        for ( int i = 0; i < 4; ++i )
+          s[i] = sm.randInt64();
+      }
+
+      /** (Re)seed the generator. */
+      void seed( const SeedVector & vseed ) {
+        seed( ( static_cast<uint64_t>(vseed[1]) << 32u ) | vseed[0] );
+      }
+
+      /** integer in [0,2^64 - 1]. */
+      uint64_t randInt64() {
+        const uint64_t result = rotl( s[1] * 5u, 7 ) * 9u;
+        const uint64_t t = s[1] << 17u;
+
+        s[2] ^= s[0];
+        s[3] ^= s[1];
+        s[1] ^= s[2];
+        s[0] ^= s[3];
+
+        s[2] ^= t;
+        s[3] = rotl( s[3], 45 );
+
+        return result;
+      }
+
+      /** integer in [0,2^32 - 1] (the upper half of randInt64()). */
+      uint32_t randInt() {
+        return static_cast<uint32_t>( randInt64() >> 32u );
+      }
+
+      /** Advance the generator by 2^128 steps. */
+      void jump() {
+        static const uint64_t J[4] = {
+          UINT64_C(0x180ec6d33cfd0aba), UINT64_C(0xd5a61266f0c9392c),
+          UINT64_C(0xa9582618e03fc9aa), UINT64_C(0x39abdc4529b1661c)
+        };
+        jump(J);
+      }
+
+      /** Advance the generator by 2^192 steps. */
+      void long_jump() {
+        static const uint64_t J[4] = {
+          UINT64_C(0x76e15d3efefdcbbf), UINT64_C(0xc5004e441c522fb3),
+          UINT64_C(0x77710069854ee241), UINT64_C(0x39109bb02acbe635)
+        };
+        jump(J);
+      }
+
+      /** Get the StateVector (by value, since the state is kept as 64 bit
+       * integers). */
+      StateVector getState() const {
+        StateVector v;
+        save(v);
+        return v;
+      }
+
+      /** Save the StateVector (lower word of each 64 bit word first) to an
+       * external storage. */
+      void save( StateVector & v ) const {
+        for ( int i = 0; i < 4; ++i ) {
+          v[2*i]   = static_cast<uint32_t>( s[i] );
+          v[2*i+1] = static_cast<uint32_t>( s[i] >> 32u );
+        }
+      }
+
+      /** Load the StateVector from an external storage. */
+      void load( const StateVector & v ) {
+        for ( int i = 0; i < 4; ++i )
+          s[i] = ( static_cast<uint64_t>(v[2*i+1]) << 32u ) | v[2*i];
+      }
+
+    private:
+      static uint64_t rotl( const uint64_t & x, const int & k ) {
+        return ( x << k ) | ( x >> (64 - k) );
+      }
+
+      /** Advance by the jump polynomial J. */
+      void jump( const uint64_t J[4] ) {
+        uint64_t t[4] = { 0u, 0u, 0u, 0u };
+        for ( int i = 0; i < 4; ++i )
+          for ( int b = 0; b < 64; ++b ) {
+            if ( J[i] & ( UINT64_C(1) << b ) )
+              for ( int j = 0; j < 4; ++j )
+                t[j] ^= s[j];
+            randInt64();
+          }
+
+        for ( int j = 0; j < 4; ++j )
+          s[j] = t[j];
+      }
+    };
+
+  }/* namespace xylose::random */
+}/* namespace xylose */
+
+#endif // xylose_random_Xoshiro256ss
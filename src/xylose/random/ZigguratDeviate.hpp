@@ -0,0 +1,213 @@
+/*==============================================================================
+ * Public Domain Contributions 2010 United States Government                   *
+ * as represented by the U.S. Air Force Research Laboratory.                   *
+ *                                                                             *
+ * This file is part of xylose                                                 *
+ *                                                                             *
+ * This program is free software: you can redistribute it and/or modify it     *
+ * under the terms of the GNU Lesser General Public License as published by    *
+ * the Free Software Foundation, either version 3 of the License, or (at your  *
+ * option) any later version.                                                  *
+ *                                                                             *
+ * This program is distributed in the hope that it will be useful, but WITHOUT *
+ * ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or       *
+ * FITNESS FOR A PARTICULAR PURPOSE.  See the GNU Lesser General Public        *
+ * License for more details.                                                   *
+ *                                                                             *
+ * You should have received a copy of the GNU Lesser General Public License    *
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.       *
+ *                                                                             *
+ -----------------------------------------------------------------------------*/
+
+
+#ifndef xylose_random_ZigguratDeviate_h
+#define xylose_random_ZigguratDeviate_h
+
+#include <xylose/random/Kiss.hpp>
+#include <xylose/random/ThreadRNG.hpp>
+
+#include <cmath>
+#include <cstddef>
+#include <algorithm>
+
+namespace xylose {
+  namespace random {
+
+    namespace detail {
+      /** Layer tables of the 128 layer ziggurat of the normal density
+       * (using Doornik's formulation).  */
+      struct ZigguratTables {
+        /** Number of layers. */
+        static const int C = 128;
+
+        /** Start of the tail (right edge of the bottom layer). */
+        static double R() { return 3.442619855899; }
+
+        /** Area of each layer. */
+        static double V() { return 9.91256303526217e-3; }
+
+        /** X[i] is the right edge of layer i (X[0] is the width that the
+         * bottom layer would have without its tail, X[C] = 0). */
+        double X[C+1];
+
+        /** Ratio X[i+1]/X[i]:  the fraction of layer i that lies entirely
+         * under the density. */
+        double ratio[C];
+
+        ZigguratTables() {
+          double f = std::exp( -0.5 * R() * R() );
+          X[0] = V() / f;
+          X[1] = R();
+          X[C] = 0.0;
+          for ( int i = 2; i < C; ++i ) {
+            X[i] = std::sqrt( -2.0 * std::log( V() / X[i-1] + f ) );
+            f = std::exp( -0.5 * X[i] * X[i] );
+          }
+
+          for ( int i = 0; i < C; ++i )
+            ratio[i] = X[i+1] / X[i];
+        }
+
+        /** The tables (made on first use). */
+        static const ZigguratTables & get() {
+          static const ZigguratTables tables;
+          return tables;
+        }
+      };
+    }
+
+    /** Normal deviates by the ziggurat method.
+     *
+     * The normal density is covered by 128 layers of equal area.  A single
+     * 32 bit draw selects the layer (7 bits) and a uniform position within
+     * it (the remaining 25 bits, including the sign).  About 99% of the
+     * draws fall in the part of a layer that lies under the density and are
+     * returned after one multiply; only the rest need an exp() (or a log()
+     * for the tail beyond R = 3.4426).
+     *
+     * Since the 25 bits of the position give the deviate a resolution of
+     * \f$ 2^{-24} \f$ relative to the width of its layer, this is intended
+     * for Monte-Carlo sampling (e.g. thermal velocities) rather than for
+     * probing extreme quantiles.
+     *
+     * Unlike GaussianDeviate, this deviate does not keep any state between
+     * calls, so that it may be used by several threads at once (with the
+     * default per-thread generator).
+     *
+     * @see G. Marsaglia and W. W. Tsang, "The ziggurat method for generating
+     *      random variables", J. Stat. Softw. 5(8) (2000).
+     * @see J. A. Doornik, "An improved ziggurat method to generate normal
+     *      random samples", (2005).
+     */
+    template < typename RNG = xylose::random::Kiss >
+    class ZigguratDeviate {
+      /* TYPEDEFS */
+    private:
+      typedef detail::ZigguratTables Tables;
+
+      /* MEMBER STORAGE */
+      /** The random number generator (NULL for the generator of the calling
+       * thread). */
+      RNG * rng;
+
+      /** The layer tables. */
+      const Tables & t;
+
+
+      /* MEMBER FUNCTIONS */
+    public:
+      /** Constructor.
+       * @param rng
+       *    The random number generator to use [default:  the generator of
+       *    the thread that draws, see ThreadRNG].
+       */
+      ZigguratDeviate( RNG & rng = ThreadRNG<RNG>::per_thread() )
+        : rng( ThreadRNG<RNG>::bind(rng) ), t( Tables::get() ) { }
+
+      /** The random number generator used by this deviate. */
+      RNG & getRNG() const {
+        return ThreadRNG<RNG>::select(rng);
+      }
+
+      /** A normal deviate with zero mean and unit variance. */
+      double operator() () const {
+        RNG & g = getRNG();
+        return draw( g, g.randInt() );
+      }
+
+      /** A normal deviate with zero mean and standard deviation sigma (as
+       * GaussianDeviate::operator()). */
+      double operator() ( const double & sigma ) const {
+        return sigma * (*this)();
+      }
+
+      /** Store n normal deviates with standard deviation sigma at out.
+       * The integers for the fast path are drawn in blocks (see
+       * RandBase::randInts); the occasional rejected draw takes further
+       * numbers from the generator.  The deviates therefore have the same
+       * distribution as, but are not the same numbers as, n single calls.
+       */
+      template < typename OutputIterator >
+      OutputIterator generate_n( OutputIterator out, std::size_t n,
+                                 const double & sigma = 1.0 ) const {
+        RNG & g = getRNG();
+        const std::size_t block = 256u;
+        uint32_t buf[block];
+        while ( n > 0u ) {
+          const std::size_t m = std::min( n, block );
+          g.randInts( buf, m );
+          for ( std::size_t k = 0u; k < m; ++k, ++out )
+            *out = sigma * draw( g, buf[k] );
+          n -= m;
+        }
+        return out;
+      }
+
+      /** Fill [first,last) with normal deviates with standard deviation
+       * sigma.  @see generate_n. */
+      template < typename ForwardIterator >
+      void fill( ForwardIterator first, ForwardIterator last,
+                 const double & sigma = 1.0 ) const {
+        generate_n( first, std::distance( first, last ), sigma );
+      }
+
+    private:
+      /** A standard normal deviate starting from the 32 bit draw r. */
+      double draw( RNG & g, uint32_t r ) const {
+        while ( true ) {
+          const int i = r & (Tables::C - 1);
+          /* u in [-1,1) from the upper 25 bits. */
+          const double u = (r >> 7u) * (1.0 / 16777216.0) - 1.0;
+          if ( std::abs(u) < t.ratio[i] )
+            return u * t.X[i];
+
+          if ( i == 0 )
+            return tail( g, u < 0 );
+
+          /* the deviate lies in the wedge of layer i that is only partly
+           * under the density. */
+          const double x = u * t.X[i];
+          const double f0 = std::exp( -0.5 * ( t.X[i]   * t.X[i]   - x*x ) );
+          const double f1 = std::exp( -0.5 * ( t.X[i+1] * t.X[i+1] - x*x ) );
+          if ( f1 + g.randExc() * (f0 - f1) < 1.0 )
+            return x;
+
+          r = g.randInt();
+        }
+      }
+
+      /** A deviate from the tail beyond R (Marsaglia 1964). */
+      double tail( RNG & g, const bool & negative ) const {
+        double x, y;
+        do {
+          x = std::log( g.randDblExc() ) / Tables::R();
+          y = std::log( g.randDblExc() );
+        } while ( -2.0 * y < x * x );
+        return negative ? x - Tables::R() : Tables::R() - x;
+      }
+    };
+
+  }/* namespace xylose::random */
+}/* namespace xylose */
+
+#endif // xylose_random_ZigguratDeviate_h
@@ -30,13 +30,17 @@
 #include <cstdio>
 #include <ctime>
 #include <cstdlib>
+#include <cstddef>
 #include <climits>
+#include <iterator>
+#include <algorithm>
 
 namespace xylose {
   namespace random {
 
     using  boost::int32_t;
     using boost::uint32_t;
+    using boost::uint64_t;
 
     namespace detail {
       using xylose::Vector;
@@ -68,6 +72,12 @@ namespace xylose {
        * - data types, static ints:
        *    - static const uint32_t rand_max;
        *    .
+       * - functions:
+       *    - void randInts(uint32_t * out, std::size_t n);
+       *      (a faster equivalent of n calls to randInt())
+       *    - uint64_t randInt64();
+       *      (for generators with native 64 bit output)
+       *    .
        */
       template < typename sub >
       struct RandBase {
@@ -84,6 +94,19 @@ namespace xylose {
         inline double randExc();    /**< Real nubmer in [0,1). */
         inline double randDblExc(); /**< Real nubmer in (0,1). */
 
+        /** Integer in [0,2^64 - 1].  This default is made from two calls to
+         * randInt() (the first giving the upper word), so that it is only
+         * uniform if rand_max = 2^32 - 1.  Generators with 64 bit output hide
+         * this with a version that takes a single step. */
+        inline uint64_t randInt64();
+
+        /** Real number in [0,1] with 53 bit resolution (from randInt64()). */
+        inline double rand53();
+        /** Real number in [0,1) with 53 bit resolution (from randInt64()). */
+        inline double randExc53();
+        /** Real number in (0,1) with 53 bit resolution (from randInt64()). */
+        inline double randDblExc53();
+
         /** Typed number in [0,x], where x depends on template parameter T.
          * The value of x depends on the type givin via the template parameter T.
          * This list shows the value of x for some types of T:
@@ -95,6 +118,34 @@ namespace xylose {
          */
         template < typename T > inline T randT();
 
+        /** Store n integers in [0,rand_max] in out.  This gives exactly the
+         * same numbers as n calls to randInt(), so bulk and single calls can
+         * be mixed freely.  This default simply calls randInt(); generators
+         * that can do better hide this with their own version. */
+        inline void randInts( uint32_t * out, std::size_t n );
+
+        /** Store n typed numbers at out and return the end of the output.
+         * The numbers have the same range as randT<T>() (where T is the
+         * value_type of the iterator) and are the same numbers that n calls
+         * to randT<T>() would give.  The generation of the underlying
+         * integers is done in blocks through randInts.
+         */
+        template < typename OutputIterator >
+        inline OutputIterator generate_n( OutputIterator out, std::size_t n );
+
+        /** Store n integers in [0,rand_max] in out (without a copy).
+         * @see randInts. */
+        inline uint32_t * generate_n( uint32_t * out, std::size_t n ) {
+          static_cast<sub&>(*this).randInts( out, n );
+          return out + n;
+        }
+
+        /** Fill [first,last) with typed numbers as by generate_n. */
+        template < typename ForwardIterator >
+        inline void fill( ForwardIterator first, ForwardIterator last ) {
+          generate_n( first, std::distance( first, last ) );
+        }
+
         /** (Re)seed with /dev/urandom or time() and clock(). 
          * If /dev/urandom is not accessible, then the results of time() and
          * clock() are hashed together to generate a seed. */
@@ -137,6 +188,35 @@ namespace xylose {
 
 
 
+      template < typename sub >
+      inline uint64_t RandBase<sub>::randInt64() {
+        const uint64_t hi = static_cast<sub&>(*this).randInt();
+        const uint64_t lo = static_cast<sub&>(*this).randInt();
+        return ( hi << 32u ) | lo;
+      }
+
+      template < typename sub >
+      inline double RandBase<sub>::rand53() {
+        const double r_scale = 1.0 / 9007199254740991.0; /* 1/(2^53 - 1) */
+        return ( static_cast<sub&>(*this).randInt64() >> 11u ) * r_scale;
+      }
+
+      template < typename sub >
+      inline double RandBase<sub>::randExc53() {
+        const double rexc_scale = 1.0 / 9007199254740992.0; /* 1/2^53 */
+        return ( static_cast<sub&>(*this).randInt64() >> 11u ) * rexc_scale;
+      }
+
+      template < typename sub >
+      inline double RandBase<sub>::randDblExc53() {
+        const double rexc_scale = 1.0 / 9007199254740992.0; /* 1/2^53 */
+        const uint64_t r = static_cast<sub&>(*this).randInt64() >> 11u;
+        return ( static_cast<double>(r) + 0.5 ) * rexc_scale;
+      }
+
+
+
+
       /** Helper class for randT<T>. */
       template < typename T >
       struct RandT {
@@ -172,6 +252,60 @@ namespace xylose {
         return RandT<T>()(*this);
       }
 
+
+      /** Helper class for generate_n:  converts randInt() values as
+       * RandT<T> does. */
+      template < typename T >
+      struct FromInt {
+        template < typename Generator >
+        static inline T convert( const uint32_t & r ) {
+          const double r_scale =
+            1.0 / static_cast<double>(Generator::rand_max);
+          return static_cast<T>( r * r_scale );
+        }
+      };
+
+      /** Helper class for generate_n of uint32_t. */
+      template <>
+      struct FromInt<uint32_t> {
+        template < typename Generator >
+        static inline uint32_t convert( const uint32_t & r ) {
+          return r;
+        }
+      };
+
+      /** Helper class for generate_n of int32_t. */
+      template <>
+      struct FromInt<int32_t> {
+        template < typename Generator >
+        static inline int32_t convert( const uint32_t & r ) {
+          return std::abs(static_cast<int32_t>(r));
+        }
+      };
+
+      template < typename sub >
+      inline void RandBase<sub>::randInts( uint32_t * out, std::size_t n ) {
+        for ( ; n > 0u; --n )
+          *out++ = static_cast<sub&>(*this).randInt();
+      }
+
+      template < typename sub >
+      template < typename OutputIterator >
+      inline OutputIterator
+      RandBase<sub>::generate_n( OutputIterator out, std::size_t n ) {
+        typedef typename std::iterator_traits<OutputIterator>::value_type T;
+        const std::size_t block = 256u;
+        uint32_t buf[block];
+        while ( n > 0u ) {
+          const std::size_t m = std::min( n, block );
+          static_cast<sub&>(*this).randInts( buf, m );
+          for ( std::size_t i = 0u; i < m; ++i, ++out )
+            *out = FromInt<T>::template convert<sub>( buf[i] );
+          n -= m;
+        }
+        return out;
+      }
+
       /* This implementation was taken from the BSD licensed MTRand from Richard
        * Wagner. */
       template < typename sub >
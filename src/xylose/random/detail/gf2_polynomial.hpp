@@ -0,0 +1,251 @@
+/*==============================================================================
+ * Public Domain Contributions 2010 United States Government                   *
+ * as represented by the U.S. Air Force Research Laboratory.                   *
+ *                                                                             *
+ * This file is part of xylose                                                 *
+ *                                                                             *
+ * This program is free software: you can redistribute it and/or modify it     *
+ * under the terms of the GNU Lesser General Public License as published by    *
+ * the Free Software Foundation, either version 3 of the License, or (at your  *
+ * option) any later version.                                                  *
+ *                                                                             *
+ * This program is distributed in the hope that it will be useful, but WITHOUT *
+ * ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or       *
+ * FITNESS FOR A PARTICULAR PURPOSE.  See the GNU Lesser General Public        *
+ * License for more details.                                                   *
+ *                                                                             *
+ * You should have received a copy of the GNU Lesser General Public License    *
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.       *
+ *                                                                             *
+ -----------------------------------------------------------------------------*/
+
+
+#ifndef xylose_random_detail_gf2_polynomial_hpp
+#define xylose_random_detail_gf2_polynomial_hpp
+
+#include <boost/cstdint.hpp>
+
+#include <vector>
+#include <algorithm>
+#include <cassert>
+
+namespace xylose {
+  namespace random {
+    namespace detail {
+
+      using boost::uint32_t;
+      using boost::uint64_t;
+
+      /** Polynomial over GF(2).  Bit (i%32) of word (i/32) is the coefficient
+       * of x^i. */
+      typedef std::vector<uint32_t> gf2_polynomial;
+
+      /** Degree of p (-1 for the zero polynomial). */
+      inline int degree( const gf2_polynomial & p ) {
+        for ( int w = static_cast<int>(p.size()) - 1; w >= 0; --w ) {
+          if ( p[w] ) {
+            int b = 31;
+            while ( !( (p[w] >> b) & 1u ) )
+              --b;
+            return 32 * w + b;
+          }
+        }
+        return -1;
+      }
+
+      /** Coefficient of x^i in p. */
+      inline bool coefficient( const gf2_polynomial & p, const int & i ) {
+        const unsigned int w = static_cast<unsigned int>(i) >> 5u;
+        return w < p.size() && ( (p[w] >> (i & 31)) & 1u );
+      }
+
+      /** The 32 bits of p starting at bit pos (p must have a spare word at
+       * the end). */
+      inline uint32_t bits_at( const gf2_polynomial & p, const int & pos ) {
+        const int w = pos >> 5, b = pos & 31;
+        return b ? ( (p[w] >> b) | (p[w+1] << (32 - b)) ) : p[w];
+      }
+
+      /** Parity of the number of set bits of v. */
+      inline uint32_t parity( uint32_t v ) {
+        v ^= v >> 16u;
+        v ^= v >> 8u;
+        v ^= v >> 4u;
+        v ^= v >> 2u;
+        v ^= v >> 1u;
+        return v & 1u;
+      }
+
+      /** p ^= q * x^s.  Only the non-zero words of q are used, so p only
+       * needs to be large enough for the actual degree of the result. */
+      inline void xor_shifted( gf2_polynomial & p,
+                               const gf2_polynomial & q,
+                               const int & s ) {
+        const int w = s >> 5, b = s & 31;
+        for ( unsigned int j = 0; j < q.size(); ++j ) {
+          if ( !q[j] )
+            continue;
+          p[w+j] ^= q[j] << b;
+          if ( b )
+            p[w+j+1] ^= q[j] >> (32 - b);
+        }
+      }
+
+      /** Characteristic polynomial of the shortest linear recurrence that
+       * generates the bits s[0..n) (Berlekamp-Massey).
+       *
+       * For the output of an \f$ F_2 \f$-linear generator with an irreducible
+       * characteristic polynomial (such as the Mersenne Twister), 2*degree
+       * bits of any non-zero sequence give the characteristic polynomial of
+       * the generator.
+       *
+       * @param s
+       *    The bits, stored as for gf2_polynomial.
+       * @param n
+       *    The number of bits.
+       */
+      inline gf2_polynomial minimal_polynomial( const gf2_polynomial & s,
+                                                const int & n ) {
+        const int n_words = n / 32 + 2;
+
+        /* the sequence in reverse order so that the discrepancy is a plain
+         * (word-wise) dot product. */
+        gf2_polynomial rs( n_words + 1, 0u );
+        for ( int i = 0; i < n; ++i )
+          if ( coefficient( s, i ) )
+            rs[ (n-1-i) >> 5 ] |= 1u << ((n-1-i) & 31);
+
+        gf2_polynomial C( n_words, 0u ), B( n_words, 0u ), T;
+        C[0] = B[0] = 1u;
+        int L = 0, m = 1;
+        for ( int k = 0; k < n; ++k ) {
+          /* d = sum_{i=0}^{L} C_i s[k-i] */
+          const int off = n - 1 - k;
+          uint32_t d = 0u;
+          for ( int j = 0; j <= (L >> 5); ++j )
+            d ^= C[j] & bits_at( rs, off + 32 * j );
+          if ( !parity(d) ) {
+            ++m;
+          } else if ( 2 * L <= k ) {
+            T = C;
+            xor_shifted( C, B, m );
+            L = k + 1 - L;
+            B.swap(T);
+            m = 1;
+          } else {
+            xor_shifted( C, B, m );
+            ++m;
+          }
+        }
+
+        /* the characteristic polynomial is the reciprocal of C. */
+        gf2_polynomial phi( L / 32 + 1, 0u );
+        for ( int i = 0; i <= L; ++i )
+          if ( coefficient( C, L - i ) )
+            phi[i >> 5] |= 1u << (i & 31);
+        return phi;
+      }
+
+
+      /** Arithmetic of polynomials modulo a fixed polynomial phi. */
+      class gf2_modulus {
+        /* MEMBER STORAGE */
+        /** The degree of phi. */
+        int L;
+
+        /** phi * x^b for b in [0,32) (so that reductions only need whole
+         * word shifts). */
+        std::vector<gf2_polynomial> shifted;
+
+        /* MEMBER FUNCTIONS */
+      public:
+        /** Constructor. */
+        gf2_modulus( const gf2_polynomial & phi )
+          : L( degree(phi) ), shifted(32) {
+          assert( L > 0 );
+          for ( int b = 0; b < 32; ++b ) {
+            shifted[b].assign( L / 32 + 2, 0u );
+            xor_shifted( shifted[b], phi, b );
+          }
+        }
+
+        /** The degree of phi. */
+        const int & getDegree() const { return L; }
+
+        /** Reduce p modulo phi in place; the result has size() words. */
+        void reduce( gf2_polynomial & p ) const {
+          for ( int i = degree(p); i >= L; --i ) {
+            if ( !coefficient( p, i ) )
+              continue;
+            const int s = i - L;
+            const gf2_polynomial & q = shifted[ s & 31 ];
+            const int w = s >> 5;
+            const int nq = static_cast<int>( std::min( q.size(), p.size() - w ) );
+            for ( int j = 0; j < nq; ++j )
+              p[w+j] ^= q[j];
+          }
+          p.resize( size(), 0u );
+        }
+
+        /** Number of words of a reduced polynomial. */
+        int size() const { return L / 32 + 1; }
+
+        /** a^2 mod phi. */
+        gf2_polynomial square( const gf2_polynomial & a ) const {
+          gf2_polynomial p( 2 * a.size() + 1, 0u );
+          for ( unsigned int j = 0; j < a.size(); ++j ) {
+            p[2*j]   = spread( a[j] & 0xffffu );
+            p[2*j+1] = spread( a[j] >> 16u );
+          }
+          reduce( p );
+          return p;
+        }
+
+        /** a * x mod phi in place. */
+        void times_x( gf2_polynomial & a ) const {
+          a.resize( size() + 1, 0u );
+          for ( int j = size(); j > 0; --j )
+            a[j] = (a[j] << 1u) | (a[j-1] >> 31u);
+          a[0] <<= 1u;
+          reduce( a );
+        }
+
+        /** x^n mod phi. */
+        gf2_polynomial power( const uint64_t & n ) const {
+          gf2_polynomial p( size(), 0u );
+          p[0] = 1u;
+          for ( int b = 63; b >= 0; --b ) {
+            p = square( p );
+            if ( (n >> b) & 1u )
+              times_x( p );
+          }
+          return p;
+        }
+
+        /** x^(2^k) mod phi. */
+        gf2_polynomial power2( const unsigned int & k ) const {
+          gf2_polynomial p( size(), 0u );
+          p[0] = 2u;
+          reduce( p );
+          for ( unsigned int i = 0; i < k; ++i )
+            p = square( p );
+          return p;
+        }
+
+      private:
+        /** Spread the 16 bits of v to the even bits of the result (squaring
+         * over GF(2)). */
+        static uint32_t spread( uint32_t v ) {
+          v = (v | (v << 8u)) & 0x00ff00ffu;
+          v = (v | (v << 4u)) & 0x0f0f0f0fu;
+          v = (v | (v << 2u)) & 0x33333333u;
+          v = (v | (v << 1u)) & 0x55555555u;
+          return v;
+        }
+      };
+
+    }/* namespace xylose::random::detail */
+  }/* namespace xylose::random */
+}/* namespace xylose */
+
+#endif // xylose_random_detail_gf2_polynomial_hpp
@@ -34,3 +34,53 @@ BOOST_AUTO_TEST_CASE( generation ) {
   XRNG::test::run< XRNG::MersenneTwister >("mersennetwister");
 }
 
+
+BOOST_AUTO_TEST_CASE( jump ) {
+  using xylose::random::MersenneTwister;
+
+  /* jumps starting from a fresh state, within a block and at the end of a
+   * block, compared with stepping the generator. */
+  const unsigned int offsets[3] = { 0u, 5u, 624u };
+  const MersenneTwister::JumpPolynomial j1000( 1000u );
+  for ( int o = 0; o < 3; ++o ) {
+    MersenneTwister a( 42u ), b( 42u );
+    for ( unsigned int i = 0; i < offsets[o]; ++i ) {
+      a.randInt();
+      b.randInt();
+    }
+
+    a.jump( 10u );
+    for ( int i = 0; i < 1024; ++i )
+      b.randInt();
+    int n_diff = 0;
+    for ( int i = 0; i < 2000; ++i )
+      n_diff += ( a.randInt() != b.randInt() );
+    BOOST_CHECK_EQUAL( n_diff, 0 );
+
+    a.jump( j1000 );
+    for ( int i = 0; i < 1000; ++i )
+      b.randInt();
+    for ( int i = 0; i < 2000; ++i )
+      n_diff += ( a.randInt() != b.randInt() );
+    BOOST_CHECK_EQUAL( n_diff, 0 );
+  }
+
+  /* 2^20 = 2^19 + 2^19 */
+  MersenneTwister a( 7u ), b( 7u );
+  a.jump( 20u );
+  b.jump( 19u );
+  b.jump( 19u );
+  int n_diff = 0;
+  for ( int i = 0; i < 1000; ++i )
+    n_diff += ( a.randInt() != b.randInt() );
+  BOOST_CHECK_EQUAL( n_diff, 0 );
+
+  /* split hands out consecutive blocks of the stream. */
+  MersenneTwister c( 7u ), d( 7u );
+  MersenneTwister c0 = c.split( j1000 );
+  for ( int i = 0; i < 1000; ++i )
+    n_diff += ( c0.randInt() != d.randInt() );
+  for ( int i = 0; i < 1000; ++i )
+    n_diff += ( c.randInt() != d.randInt() );
+  BOOST_CHECK_EQUAL( n_diff, 0 );
+}
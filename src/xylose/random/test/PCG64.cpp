@@ -0,0 +1,113 @@
+/*==============================================================================
+ * Public Domain Contributions 2010 United States Government                   *
+ * as represented by the U.S. Air Force Research Laboratory.                   *
+ *                                                                             *
+ * This file is part of xylose                                                 *
+ *                                                                             *
+ * This program is free software: you can redistribute it and/or modify it     *
+ * under the terms of the GNU Lesser General Public License as published by    *
+ * the Free Software Foundation, either version 3 of the License, or (at your  *
+ * option) any later version.                                                  *
+ *                                                                             *
+ * This program is distributed in the hope that it will be useful, but WITHOUT *
+ * ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or       *
+ * FITNESS FOR A PARTICULAR PURPOSE.  See the GNU Lesser General Public        *
+ * License for more details.                                                   *
+ *                                                                             *
+ * You should have received a copy of the GNU Lesser General Public License    *
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.       *
+ *                                                                             *
+ -----------------------------------------------------------------------------*/
+
+#define BOOST_TEST_MODULE random_PCG64
+
+#include <xylose/random/test/common.hpp>
+#include <xylose/random/PCG64.hpp>
+
+#include <boost/test/unit_test.hpp>
+
+#include <vector>
+
+
+BOOST_AUTO_TEST_CASE( uint128 ) {
+  using xylose::random::detail::uint128;
+
+  const uint128 a( UINT64_C(0x0123456789abcdef), UINT64_C(0xfedcba9876543210) );
+  const uint128 b( UINT64_C(0xffffffffffffffff), UINT64_C(0xffffffffffffffff) );
+
+  /* a + (2^128 - 1) = a - 1 and a * (2^128 - 1) = -a. */
+  const uint128 s = a + b, p = a * b;
+  BOOST_CHECK_EQUAL( s.hi, a.hi );
+  BOOST_CHECK_EQUAL( s.lo, a.lo - 1u );
+  BOOST_CHECK_EQUAL( p.hi, ~a.hi );
+  BOOST_CHECK_EQUAL( p.lo, ~a.lo + 1u );
+
+  const uint128 m = uint128::mul( UINT64_C(0xffffffffffffffff),
+                                  UINT64_C(0xffffffffffffffff) );
+  BOOST_CHECK_EQUAL( m.hi, UINT64_C(0xfffffffffffffffe) );
+  BOOST_CHECK_EQUAL( m.lo, UINT64_C(1) );
+}
+
+BOOST_AUTO_TEST_CASE( regression ) {
+  using xylose::random::PCG64;
+
+  /* the first outputs for the reference seeding with initstate 42 and
+   * initseq 54. */
+  PCG64 r(0u);
+  r.seed( PCG64::uint128(0u, 42u), PCG64::uint128(0u, 54u) );
+  BOOST_CHECK_EQUAL( r.randInt64(), UINT64_C(0x12fc5a20bf7316cd) );
+  BOOST_CHECK_EQUAL( r.randInt64(), UINT64_C(0x5afed1a57d3ff4bb) );
+  BOOST_CHECK_EQUAL( r.randInt64(), UINT64_C(0x7919a15aa340012e) );
+}
+
+BOOST_AUTO_TEST_CASE( discard_and_streams ) {
+  using xylose::random::PCG64;
+  using xylose::random::uint64_t;
+
+  PCG64 r(1234u, 7u);
+  std::vector<uint64_t> v(100);
+  for ( unsigned int i = 0; i < v.size(); ++i )
+    v[i] = r.randInt64();
+
+  for ( unsigned int n = 0; n < v.size(); n += 9u ) {
+    PCG64 s(1234u, 7u);
+    s.discard(n);
+    BOOST_CHECK_EQUAL( s.randInt64(), v[n] );
+  }
+
+  /* state round trip. */
+  PCG64 s(1234u, 7u);
+  s.discard(50u);
+  PCG64 t( s.getState() );
+  BOOST_CHECK_EQUAL( t.randInt64(), v[50] );
+
+  /* another stream of the same seed. */
+  PCG64 u(1234u, 8u);
+  int n_same = 0;
+  for ( unsigned int i = 0; i < v.size(); ++i )
+    n_same += ( u.randInt64() == v[i] );
+  BOOST_CHECK_EQUAL( n_same, 0 );
+}
+
+BOOST_AUTO_TEST_CASE( default_seed ) {
+  using xylose::random::PCG64;
+  using xylose::random::uint64_t;
+
+  /* default constructed generators are seeded (differently) and can be
+   * drawn from. */
+  PCG64 a, b;
+  int n_same = 0, n_bad = 0;
+  for ( int i = 0; i < 1000; ++i ) {
+    const uint64_t x = a.randInt64(), y = b.randInt64();
+    n_same += ( x == y );
+    const double u = a.rand();
+    n_bad += ( u < 0.0 || u > 1.0 );
+  }
+  BOOST_CHECK_EQUAL( n_same, 0 );
+  BOOST_CHECK_EQUAL( n_bad, 0 );
+}
+
+BOOST_AUTO_TEST_CASE( generation ) {
+  namespace XRNG = xylose::random;
+  XRNG::test::run< XRNG::PCG64 >("pcg64", true);
+}
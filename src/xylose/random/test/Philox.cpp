@@ -0,0 +1,124 @@
+/*==============================================================================
+ * Public Domain Contributions 2010 United States Government                   *
+ * as represented by the U.S. Air Force Research Laboratory.                   *
+ *                                                                             *
+ * This file is part of xylose                                                 *
+ *                                                                             *
+ * This program is free software: you can redistribute it and/or modify it     *
+ * under the terms of the GNU Lesser General Public License as published by    *
+ * the Free Software Foundation, either version 3 of the License, or (at your  *
+ * option) any later version.                                                  *
+ *                                                                             *
+ * This program is distributed in the hope that it will be useful, but WITHOUT *
+ * ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or       *
+ * FITNESS FOR A PARTICULAR PURPOSE.  See the GNU Lesser General Public        *
+ * License for more details.                                                   *
+ *                                                                             *
+ * You should have received a copy of the GNU Lesser General Public License    *
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.       *
+ *                                                                             *
+ -----------------------------------------------------------------------------*/
+
+#define BOOST_TEST_MODULE random_Philox
+
+#include <xylose/random/test/common.hpp>
+#include <xylose/random/Philox.hpp>
+
+#include <boost/test/unit_test.hpp>
+
+#include <vector>
+
+
+BOOST_AUTO_TEST_CASE( known_answers ) {
+  using xylose::random::Philox;
+  using xylose::random::uint32_t;
+
+  /* known-answer vectors of philox4x32_10 from Random123. */
+  const uint32_t ctr[3][4] = {
+    { 0x00000000u, 0x00000000u, 0x00000000u, 0x00000000u },
+    { 0xffffffffu, 0xffffffffu, 0xffffffffu, 0xffffffffu },
+    { 0x243f6a88u, 0x85a308d3u, 0x13198a2eu, 0x03707344u },
+  };
+  const uint32_t key[3][2] = {
+    { 0x00000000u, 0x00000000u },
+    { 0xffffffffu, 0xffffffffu },
+    { 0xa4093822u, 0x299f31d0u },
+  };
+  const uint32_t expected[3][4] = {
+    { 0x6627e8d5u, 0xe169c58du, 0xbc57ac4cu, 0x9b00dbd8u },
+    { 0x408f276du, 0x41c83b0eu, 0xa20bc7c6u, 0x6d5451fdu },
+    { 0xd16cfe09u, 0x94fdccebu, 0x5001e420u, 0x24126ea1u },
+  };
+
+  for ( int i = 0; i < 3; ++i ) {
+    uint32_t out[4];
+    Philox::bijection( ctr[i], key[i], out );
+    for ( int j = 0; j < 4; ++j )
+      BOOST_CHECK_EQUAL( out[j], expected[i][j] );
+  }
+
+  /* the stream of (seed 0, stream 0) starts with the block of counter 0. */
+  Philox r(0u, 0u);
+  for ( int j = 0; j < 4; ++j )
+    BOOST_CHECK_EQUAL( r.randInt(), expected[0][j] );
+}
+
+BOOST_AUTO_TEST_CASE( seek_and_state ) {
+  using xylose::random::Philox;
+  using xylose::random::uint32_t;
+
+  Philox r(1234u, 7u);
+  std::vector<uint32_t> v(23);
+  for ( unsigned int i = 0; i < v.size(); ++i )
+    v[i] = r.randInt();
+  BOOST_CHECK_EQUAL( r.tell(), 23u );
+
+  /* random access into the stream. */
+  for ( unsigned int n = 0; n < v.size(); ++n ) {
+    Philox s(1234u, 7u);
+    s.seek(n);
+    BOOST_CHECK_EQUAL( s.tell(), n );
+    BOOST_CHECK_EQUAL( s.randInt(), v[n] );
+  }
+
+  Philox s(1234u, 7u);
+  s.discard(5u);
+  s.discard(6u);
+  BOOST_CHECK_EQUAL( s.randInt(), v[11] );
+
+  /* save/load in the middle of a block. */
+  Philox::StateVector state;
+  s.save( state );
+  BOOST_CHECK_EQUAL( Philox(state).randInt(), v[12] );
+  BOOST_CHECK_EQUAL( s.randInt(), v[12] );
+
+  /* different streams of the same seed differ. */
+  Philox t(1234u, 8u);
+  int n_same = 0;
+  for ( unsigned int i = 0; i < v.size(); ++i )
+    n_same += ( t.randInt() == v[i] );
+  BOOST_CHECK_EQUAL( n_same, 0 );
+}
+
+BOOST_AUTO_TEST_CASE( default_seed ) {
+  using xylose::random::Philox;
+  using xylose::random::uint32_t;
+
+  /* default constructed generators are seeded (differently) and can be
+   * drawn from across many output blocks. */
+  Philox a, b;
+  int n_same = 0, n_bad = 0;
+  for ( int i = 0; i < 1000; ++i ) {
+    const uint32_t x = a.randInt(), y = b.randInt();
+    n_same += ( x == y );
+    const double u = a.rand();
+    n_bad += ( u < 0.0 || u > 1.0 );
+  }
+  BOOST_CHECK_LT( n_same, 10 );
+  BOOST_CHECK_EQUAL( n_bad, 0 );
+}
+
+BOOST_AUTO_TEST_CASE( generation ) {
+  namespace XRNG = xylose::random;
+  XRNG::test::run< XRNG::Philox >("philox", true);
+}
@@ -0,0 +1,133 @@
+/*==============================================================================
+ * Public Domain Contributions 2010 United States Government                   *
+ * as represented by the U.S. Air Force Research Laboratory.                   *
+ *                                                                             *
+ * This file is part of xylose                                                 *
+ *                                                                             *
+ * This program is free software: you can redistribute it and/or modify it     *
+ * under the terms of the GNU Lesser General Public License as published by    *
+ * the Free Software Foundation, either version 3 of the License, or (at your  *
+ * option) any later version.                                                  *
+ *                                                                             *
+ * This program is distributed in the hope that it will be useful, but WITHOUT *
+ * ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or       *
+ * FITNESS FOR A PARTICULAR PURPOSE.  See the GNU Lesser General Public        *
+ * License for more details.                                                   *
+ *                                                                             *
+ * You should have received a copy of the GNU Lesser General Public License    *
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.       *
+ *                                                                             *
+ -----------------------------------------------------------------------------*/
+
+#define BOOST_TEST_MODULE random_PoissonianSampler
+
+#include <xylose/random/PoissonianDeviate.hpp>
+#include <xylose/random/Kiss.hpp>
+#include <xylose/Timer.h>
+
+#include <boost/test/unit_test.hpp>
+
+#include <vector>
+#include <cmath>
+
+namespace {
+  using xylose::random::Kiss;
+  using xylose::random::PoissonianSampler;
+  using xylose::random::PoissonianDeviate;
+
+  void check_moments( const double & lam ) {
+    Kiss rng(1u);
+    PoissonianSampler<> s( lam, rng );
+    BOOST_CHECK_EQUAL( s.getLambda(), lam );
+
+    const int n = 1000000;
+    std::vector<unsigned long long> x(n);
+    s.fill( x.begin(), x.end() );
+
+    double s1 = 0, s2 = 0;
+    for ( int i = 0; i < n; ++i ) {
+      s1 += x[i];
+      s2 += double(x[i]) * x[i];
+    }
+    const double mean = s1 / n;
+    const double var = s2 / n - mean*mean;
+    BOOST_CHECK_SMALL( mean - lam, 5.0 * std::sqrt(lam / n) );
+    BOOST_CHECK_CLOSE( var, lam, 1.0 );
+  }
+}
+
+BOOST_AUTO_TEST_SUITE( Poissonian );
+
+BOOST_AUTO_TEST_CASE( table ) {
+  /* every cdf entry of the table must match the pmf that it sums. */
+  const double lam = 4.5;
+  xylose::random::detail::PoissonTable t(lam);
+  double p = std::exp(-lam), c = p;
+  for ( unsigned int k = 0u; k + 1u < t.cdf.size(); ++k ) {
+    BOOST_CHECK_CLOSE( t.cdf[k], c, 1e-10 );
+    p *= lam / (k+1);
+    c += p;
+  }
+  BOOST_CHECK_EQUAL( t.cdf.back(), 1.0 );
+
+  /* the inverse at the steps of the cdf. */
+  BOOST_CHECK_EQUAL( t(0.0), 0u );
+  BOOST_CHECK_EQUAL( t(t.cdf[3]), 4u );
+  BOOST_CHECK_EQUAL( t(t.cdf[3] * (1.0 - 1e-15)), 3u );
+  BOOST_CHECK_LT( t(1.0 - 1e-16), t.cdf.size() );
+  BOOST_CHECK_GT( t.cdf[ t(1.0 - 1e-16) ], 1.0 - 1e-16 );
+}
+
+BOOST_AUTO_TEST_CASE( moments ) {
+  check_moments( 0.1 );
+  check_moments( 3.0 );
+  check_moments( 9.9 );
+  check_moments( 10.0 );
+  check_moments( 250.0 );
+}
+
+BOOST_AUTO_TEST_CASE( zero ) {
+  Kiss rng(1u);
+  PoissonianSampler<> s( 0.0, rng );
+  for ( int i = 0; i < 1000; ++i )
+    BOOST_CHECK_EQUAL( s(), 0u );
+}
+
+BOOST_AUTO_TEST_CASE( batch ) {
+  /* with the table, the batch draws the same numbers as single calls. */
+  Kiss r0(2u), r1(2u);
+  PoissonianSampler<> s0( 2.0, r0 ), s1( 2.0, r1 );
+  std::vector<unsigned long long> x(1000);
+  BOOST_CHECK( s0.generate_n( x.begin(), x.size() ) == x.end() );
+  for ( unsigned int i = 0u; i < x.size(); ++i )
+    BOOST_CHECK_EQUAL( x[i], s1() );
+}
+
+BOOST_AUTO_TEST_CASE( timing ) {
+  const double lams[] = { 2.0, 50.0 };
+  const int n = 2000000;
+  std::vector<unsigned long long> x(n);
+
+  for ( int l = 0; l < 2; ++l ) {
+    Kiss rng(3u);
+    PoissonianDeviate<> d( rng );
+    PoissonianSampler<> s( lams[l], rng );
+    xylose::Timer timer;
+
+    timer.start();
+    for ( int i = 0; i < n; ++i )
+      x[i] = d( lams[l] );
+    timer.stop();
+    const double t_d = timer.dt;
+
+    timer.start();
+    s.fill( x.begin(), x.end() );
+    timer.stop();
+
+    BOOST_TEST_MESSAGE( "lambda=" << lams[l]
+                     << ":  PoissonianDeviate " << n / t_d
+                     << "/s, PoissonianSampler " << n / timer.dt << "/s" );
+  }
+}
+
+BOOST_AUTO_TEST_SUITE_END();
@@ -0,0 +1,162 @@
+/*==============================================================================
+ * Public Domain Contributions 2010 United States Government                   *
+ * as represented by the U.S. Air Force Research Laboratory.                   *
+ *                                                                             *
+ * This file is part of xylose                                                 *
+ *                                                                             *
+ * This program is free software: you can redistribute it and/or modify it     *
+ * under the terms of the GNU Lesser General Public License as published by    *
+ * the Free Software Foundation, either version 3 of the License, or (at your  *
+ * option) any later version.                                                  *
+ *                                                                             *
+ * This program is distributed in the hope that it will be useful, but WITHOUT *
+ * ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or       *
+ * FITNESS FOR A PARTICULAR PURPOSE.  See the GNU Lesser General Public        *
+ * License for more details.                                                   *
+ *                                                                             *
+ * You should have received a copy of the GNU Lesser General Public License    *
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.       *
+ *                                                                             *
+ -----------------------------------------------------------------------------*/
+
+#define BOOST_TEST_MODULE random_ThreadRNG
+
+#include <xylose/random/ThreadRNG.hpp>
+#include <xylose/random/GaussianDeviate.hpp>
+#include <xylose/distribution/Inverter.h>
+#include <xylose/distribution/Uniform.h>
+#include <xylose/PThreadEval.h>
+
+#include <boost/test/unit_test.hpp>
+
+#include <vector>
+
+namespace {
+  using xylose::random::Kiss;
+  using xylose::random::uint32_t;
+  typedef xylose::random::ThreadRNG<Kiss> Registry;
+
+  /* records the generator address and the first few numbers of the thread
+   * that runs the task. */
+  struct Draw : xylose::DefaultPThreadFunctor {
+    const Kiss ** rng;
+    uint32_t * values;
+    int * index;
+
+    Draw( const Kiss ** rng, uint32_t * values, int * index )
+      : rng(rng), values(values), index(index) { }
+
+    void operator() () {
+      *rng = &Registry::get();
+      *index = Registry::getThreadIndex();
+      for ( int i = 0; i < 4; ++i )
+        values[i] = Registry::get().randInt();
+    }
+  };
+
+  /* samples from an Inverter that uses the per-thread generator. */
+  struct Sample : xylose::DefaultPThreadFunctor {
+    const xylose::distribution::Inverter<Kiss> * inv;
+    int * n_bad;
+
+    Sample( const xylose::distribution::Inverter<Kiss> * inv, int * n_bad )
+      : inv(inv), n_bad(n_bad) { }
+
+    void operator() () {
+      for ( int i = 0; i < 100000; ++i ) {
+        const double x = (*inv)();
+        if ( x < -0.5 || x > 0.5 )
+          ++(*n_bad);
+      }
+    }
+  };
+}
+
+BOOST_AUTO_TEST_SUITE( ThreadRNG );
+
+BOOST_AUTO_TEST_CASE( deterministic_seed ) {
+  Registry::seed( 42u );
+  Registry::setThreadIndex( 3 );
+  BOOST_CHECK_EQUAL( Registry::getThreadIndex(), 3 );
+  BOOST_CHECK_EQUAL( Registry::getMasterSeed(), 42u );
+
+  std::vector<uint32_t> v(10);
+  for ( unsigned int i = 0; i < v.size(); ++i )
+    v[i] = Registry::get().randInt();
+
+  /* same master seed and index:  same numbers. */
+  Registry::seed( 42u );
+  int n_diff = 0;
+  for ( unsigned int i = 0; i < v.size(); ++i )
+    n_diff += ( Registry::get().randInt() != v[i] );
+  BOOST_CHECK_EQUAL( n_diff, 0 );
+
+  /* the generator is seeded from the Philox stream (master, index). */
+  xylose::random::Philox p( 42u, 3u );
+  Kiss::SeedVector sv;
+  for ( unsigned int i = 0; i < Kiss::seed_length; ++i )
+    sv[i] = p.randInt();
+  Kiss k( sv );
+  BOOST_CHECK_EQUAL( k.randInt(), v[0] );
+
+  /* another index gives another sequence. */
+  Registry::setThreadIndex( 4 );
+  n_diff = 0;
+  for ( unsigned int i = 0; i < v.size(); ++i )
+    n_diff += ( Registry::get().randInt() != v[i] );
+  BOOST_CHECK_EQUAL( n_diff, static_cast<int>( v.size() ) );
+}
+
+BOOST_AUTO_TEST_CASE( per_thread ) {
+  const int n_tasks = 8;
+  xylose::PThreadCache cache;
+  cache.set_max_threads( 4 );
+
+  std::vector<const Kiss *> rng( n_tasks, static_cast<const Kiss*>(NULL) );
+  std::vector<uint32_t> values( 4 * n_tasks );
+  std::vector<int> index( n_tasks );
+  {
+    xylose::PThreadEval<Draw> eval( cache );
+    for ( int t = 0; t < n_tasks; ++t )
+      eval.eval( Draw( &rng[t], &values[4*t], &index[t] ) );
+    eval.joinAll();
+  }
+
+  /* tasks that ran on different threads used different generators with
+   * different thread indices. */
+  for ( int t = 0; t < n_tasks; ++t ) {
+    BOOST_CHECK( rng[t] != NULL );
+    for ( int u = 0; u < t; ++u ) {
+      BOOST_CHECK_EQUAL( rng[t] == rng[u], index[t] == index[u] );
+      if ( rng[t] != rng[u] )
+        BOOST_CHECK( values[4*t] != values[4*u] );
+    }
+  }
+}
+
+BOOST_AUTO_TEST_CASE( samplers ) {
+  namespace dist = xylose::distribution;
+
+  /* by default, samplers draw from the generator of the calling thread. */
+  xylose::random::GaussianDeviate<Kiss> g;
+  BOOST_CHECK( &g.getRNG() == &Registry::get() );
+
+  Kiss k( 1u );
+  xylose::random::GaussianDeviate<Kiss> gk( k );
+  BOOST_CHECK( &gk.getRNG() == &k );
+
+  const dist::Inverter<Kiss> inv( dist::Uniform(), -0.5, 0.5, 100 );
+  BOOST_CHECK( &inv.getRNG() == &Registry::get() );
+
+  xylose::PThreadCache cache;
+  cache.set_max_threads( 4 );
+  std::vector<int> n_bad( 4, 0 );
+  xylose::PThreadEval<Sample> eval( cache );
+  for ( int t = 0; t < 4; ++t )
+    eval.eval( Sample( &inv, &n_bad[t] ) );
+  eval.joinAll();
+  for ( int t = 0; t < 4; ++t )
+    BOOST_CHECK_EQUAL( n_bad[t], 0 );
+}
+
+BOOST_AUTO_TEST_SUITE_END();
@@ -0,0 +1,94 @@
+/*==============================================================================
+ * Public Domain Contributions 2010 United States Government                   *
+ * as represented by the U.S. Air Force Research Laboratory.                   *
+ *                                                                             *
+ * This file is part of xylose                                                 *
+ *                                                                             *
+ * This program is free software: you can redistribute it and/or modify it     *
+ * under the terms of the GNU Lesser General Public License as published by    *
+ * the Free Software Foundation, either version 3 of the License, or (at your  *
+ * option) any later version.                                                  *
+ *                                                                             *
+ * This program is distributed in the hope that it will be useful, but WITHOUT *
+ * ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or       *
+ * FITNESS FOR A PARTICULAR PURPOSE.  See the GNU Lesser General Public        *
+ * License for more details.                                                   *
+ *                                                                             *
+ * You should have received a copy of the GNU Lesser General Public License    *
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.       *
+ *                                                                             *
+ -----------------------------------------------------------------------------*/
+
+#define BOOST_TEST_MODULE random_Xoshiro256ss
+
+#include <xylose/random/test/common.hpp>
+#include <xylose/random/Xoshiro256ss.hpp>
+#include <xylose/random/SplitMix64.hpp>
+
+#include <boost/test/unit_test.hpp>
+
+
+BOOST_AUTO_TEST_CASE( known_answers ) {
+  using xylose::random::Xoshiro256ss;
+
+  /* the first outputs of the reference xoshiro256starstar.c from the state
+   * {1,2,3,4}. */
+  Xoshiro256ss::StateVector s(0u);
+  s[0] = 1u; s[2] = 2u; s[4] = 3u; s[6] = 4u;
+  Xoshiro256ss r(s);
+  BOOST_CHECK_EQUAL( r.randInt64(), UINT64_C(11520) );
+  BOOST_CHECK_EQUAL( r.randInt64(), UINT64_C(0) );
+  BOOST_CHECK_EQUAL( r.randInt64(), UINT64_C(1509978240) );
+  BOOST_CHECK_EQUAL( r.randInt64(), UINT64_C(1215971899390074240) );
+
+  /* seeding expands the seed with SplitMix64. */
+  xylose::random::SplitMix64 sm(42u);
+  Xoshiro256ss::StateVector expected;
+  for ( int i = 0; i < 4; ++i ) {
+    const xylose::random::uint64_t w = sm.randInt64();
+    expected[2*i]   = static_cast<xylose::random::uint32_t>( w );
+    expected[2*i+1] = static_cast<xylose::random::uint32_t>( w >> 32u );
+  }
+  BOOST_CHECK( Xoshiro256ss(42u).getState() == expected );
+}
+
+BOOST_AUTO_TEST_CASE( jumps ) {
+  using xylose::random::Xoshiro256ss;
+
+  /* jumps give distinct sequences and are deterministic. */
+  Xoshiro256ss a(7u), b(7u), c(7u);
+  b.jump();
+  c.long_jump();
+  Xoshiro256ss b2(7u);
+  b2.jump();
+  int n_same = 0;
+  for ( int i = 0; i < 1000; ++i ) {
+    const xylose::random::uint64_t x = a.randInt64(), y = b.randInt64();
+    n_same += ( x == y ) + ( y == c.randInt64() );
+    BOOST_CHECK_EQUAL( y, b2.randInt64() );
+  }
+  BOOST_CHECK_EQUAL( n_same, 0 );
+}
+
+BOOST_AUTO_TEST_CASE( default_seed ) {
+  using xylose::random::Xoshiro256ss;
+  using xylose::random::uint64_t;
+
+  /* default constructed generators are seeded (differently) and can be
+   * drawn from. */
+  Xoshiro256ss a, b;
+  int n_same = 0, n_bad = 0;
+  for ( int i = 0; i < 1000; ++i ) {
+    const uint64_t x = a.randInt64(), y = b.randInt64();
+    n_same += ( x == y );
+    const double u = a.rand();
+    n_bad += ( u < 0.0 || u > 1.0 );
+  }
+  BOOST_CHECK_EQUAL( n_same, 0 );
+  BOOST_CHECK_EQUAL( n_bad, 0 );
+}
+
+BOOST_AUTO_TEST_CASE( generation ) {
+  namespace XRNG = xylose::random;
+  XRNG::test::run< XRNG::Xoshiro256ss >("xoshiro256ss", true);
+}
@@ -0,0 +1,172 @@
+/*==============================================================================
+ * Public Domain Contributions 2010 United States Government                   *
+ * as represented by the U.S. Air Force Research Laboratory.                   *
+ *                                                                             *
+ * This file is part of xylose                                                 *
+ *                                                                             *
+ * This program is free software: you can redistribute it and/or modify it     *
+ * under the terms of the GNU Lesser General Public License as published by    *
+ * the Free Software Foundation, either version 3 of the License, or (at your  *
+ * option) any later version.                                                  *
+ *                                                                             *
+ * This program is distributed in the hope that it will be useful, but WITHOUT *
+ * ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or       *
+ * FITNESS FOR A PARTICULAR PURPOSE.  See the GNU Lesser General Public        *
+ * License for more details.                                                   *
+ *                                                                             *
+ * You should have received a copy of the GNU Lesser General Public License    *
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.       *
+ *                                                                             *
+ -----------------------------------------------------------------------------*/
+
+#define BOOST_TEST_MODULE random_ZigguratDeviate
+
+#include <xylose/random/ZigguratDeviate.hpp>
+#include <xylose/random/GaussianDeviate.hpp>
+#include <xylose/random/Kiss.hpp>
+#include <xylose/random/MersenneTwister.hpp>
+#include <xylose/Timer.h>
+
+#include <boost/test/unit_test.hpp>
+
+#include <vector>
+#include <cmath>
+#include <iostream>
+
+namespace {
+  /* the moments and tail fractions of a sample. */
+  struct Moments {
+    double mean, var, kurt, tail;
+
+    Moments() : mean(0), var(0), kurt(0), tail(0) { }
+
+    template < typename Iter >
+    Moments( Iter i, const Iter & end ) : mean(0), var(0), kurt(0), tail(0) {
+      const double n = std::distance(i, end);
+      double s1 = 0, s2 = 0, s4 = 0;
+      for ( ; i != end; ++i ) {
+        const double x = *i;
+        s1 += x;
+        s2 += x*x;
+        s4 += x*x*x*x;
+        if ( std::abs(x) > 3.442619855899 )
+          tail += 1.0;
+      }
+      mean = s1 / n;
+      var  = s2 / n - mean*mean;
+      kurt = s4 / n / (var*var);
+      tail /= n;
+    }
+  };
+
+  /* chi^2 of the histogram of x over 40 bins on [-4,4) against the normal
+   * distribution. */
+  double chi2( const std::vector<double> & x, const double & sigma = 1.0 ) {
+    const int nb = 40;
+    const double lo = -4.0, dx = 8.0 / nb;
+    std::vector<double> h(nb, 0.0);
+    for ( unsigned int i = 0u; i < x.size(); ++i ) {
+      const int b = static_cast<int>( std::floor( (x[i]/sigma - lo) / dx ) );
+      if ( b >= 0 && b < nb )
+        h[b] += 1.0;
+    }
+
+    double c = 0.0;
+    for ( int b = 0; b < nb; ++b ) {
+      const double a = lo + b*dx;
+      const double p = 0.5 * ( erf( (a+dx)/M_SQRT2 ) - erf( a/M_SQRT2 ) );
+      const double e = p * x.size();
+      c += (h[b] - e) * (h[b] - e) / e;
+    }
+    return c;
+  }
+}
+
+BOOST_AUTO_TEST_SUITE( ZigguratDeviate );
+
+BOOST_AUTO_TEST_CASE( tables ) {
+  using xylose::random::detail::ZigguratTables;
+  const ZigguratTables & t = ZigguratTables::get();
+
+  /* the layers must shrink monotonically up to the peak of the density and
+   * the top layer must end at x=0 with an area of V. */
+  for ( int i = 1; i < ZigguratTables::C; ++i )
+    BOOST_CHECK_LT( t.X[i+1], t.X[i] );
+  BOOST_CHECK_CLOSE( t.X[ZigguratTables::C-1] *
+                     ( 1.0 - std::exp( -0.5 * std::pow(
+                                   t.X[ZigguratTables::C-1], 2 ) ) ),
+                     ZigguratTables::V(), 1e-3 );
+}
+
+BOOST_AUTO_TEST_CASE( distribution ) {
+  xylose::random::Kiss rng(1u);
+  xylose::random::ZigguratDeviate<> z(rng);
+  BOOST_CHECK_EQUAL( &z.getRNG(), &rng );
+
+  const int n = 2000000;
+  std::vector<double> x(n);
+  for ( int i = 0; i < n; ++i )
+    x[i] = z();
+
+  const Moments m( x.begin(), x.end() );
+  BOOST_CHECK_SMALL( m.mean, 5.0 / std::sqrt(double(n)) );
+  BOOST_CHECK_CLOSE( m.var, 1.0, 0.5 );
+  BOOST_CHECK_CLOSE( m.kurt, 3.0, 1.5 );
+  /* P(|x| > R) = erfc(R/sqrt(2)) */
+  BOOST_CHECK_CLOSE( m.tail, erfc( 3.442619855899 / M_SQRT2 ), 10.0 );
+  /* 39 degrees of freedom:  the 99.9% quantile is about 72. */
+  BOOST_CHECK_LT( chi2(x), 72.0 );
+}
+
+BOOST_AUTO_TEST_CASE( batch ) {
+  xylose::random::MersenneTwister rng(2u);
+  xylose::random::ZigguratDeviate<xylose::random::MersenneTwister> z(rng);
+
+  const int n = 2000000;
+  const double sigma = 2.5;
+  std::vector<double> x(n);
+  z.fill( x.begin(), x.end(), sigma );
+
+  const Moments m( x.begin(), x.end() );
+  BOOST_CHECK_SMALL( m.mean, 5.0 * sigma / std::sqrt(double(n)) );
+  BOOST_CHECK_CLOSE( m.var, sigma*sigma, 0.5 );
+  BOOST_CHECK_LT( chi2(x, sigma), 72.0 );
+
+  /* generate_n must return the end of what it wrote. */
+  double y[3] = { 0, 0, 0 };
+  BOOST_CHECK( z.generate_n( y, 2u ) == y + 2 );
+  BOOST_CHECK_EQUAL( y[2], 0.0 );
+}
+
+BOOST_AUTO_TEST_CASE( timing ) {
+  xylose::random::Kiss rng(3u);
+  xylose::random::GaussianDeviate<> g(rng);
+  xylose::random::ZigguratDeviate<> z(rng);
+
+  const int n = 10000000;
+  std::vector<double> x(n);
+  xylose::Timer timer;
+
+  timer.start();
+  for ( int i = 0; i < n; ++i )
+    x[i] = g(1.0);
+  timer.stop();
+  const double t_g = timer.dt;
+
+  timer.start();
+  for ( int i = 0; i < n; ++i )
+    x[i] = z();
+  timer.stop();
+  const double t_z = timer.dt;
+
+  timer.start();
+  z.fill( x.begin(), x.end() );
+  timer.stop();
+  const double t_zb = timer.dt;
+
+  BOOST_TEST_MESSAGE( "normals/s:  GaussianDeviate " << n / t_g
+                   << ", ZigguratDeviate " << n / t_z
+                   << ", ZigguratDeviate::fill " << n / t_zb );
+}
+
+BOOST_AUTO_TEST_SUITE_END();
@@ -31,6 +31,8 @@
 
 #include <string>
 #include <fstream>
+#include <vector>
+#include <cmath>
 
 namespace xylose {
   namespace random {
@@ -158,6 +160,84 @@ namespace xylose {
         }
       }
 
+      /** Test that the bulk functions (generate_n, fill) give the same
+       * sequence as single calls, also when the two are mixed. */
+      template < typename RNG >
+      inline void testBulk() {
+        const unsigned int n = 3000u;
+        std::vector<uint32_t> ref(n);
+        {
+          RNG r( 12345u );
+          for ( unsigned int i = 0; i < n; ++i )
+            ref[i] = r.randInt();
+        }
+
+        {
+          RNG r( 12345u );
+          std::vector<uint32_t> v(n);
+          v[0] = r.randInt();
+          r.generate_n( &v[1], 700u );
+          v[701] = r.randInt();
+          r.fill( v.begin() + 702, v.begin() + 1500 );
+          r.generate_n( &v[1500], n - 1500u );
+          BOOST_CHECK( v == ref );
+        }
+
+        {
+          RNG r( 12345u ), s( 12345u );
+          std::vector<double> d(n);
+          r.fill( d.begin(), d.end() );
+          int n_diff = 0;
+          for ( unsigned int i = 0; i < n; ++i )
+            n_diff += ( d[i] != s.rand() );
+          BOOST_CHECK_EQUAL( n_diff, 0 );
+        }
+      }
+
+      /** Time the bulk generation of a random number generator. */
+      template < typename RNG >
+      inline void timeRNGBulk() {
+        RNG r;
+        std::vector<uint32_t> buf( 1u << 16u );
+        unsigned long junk = 0u;
+        const unsigned long n_blocks = 100000000UL / buf.size();
+        xylose::Timer timer;
+        timer.start();
+        for ( unsigned long i = 0; i < n_blocks; ++i ) {
+          r.generate_n( &buf[0], buf.size() );
+          junk ^= buf[i % buf.size()];
+        }
+        timer.stop();
+
+        /* make sure that junk isn't optimized away */
+        BOOST_CHECK_EQUAL( junk, junk );
+
+        BOOST_TEST_MESSAGE(
+          "Bulk generation rate:  "
+          << (1e-6 * n_blocks * buf.size() / timer.dt)
+          << " million per second"
+        );
+      }
+
+      /** Test the 53 bit real numbers:  their range and, for generators
+       * with full 32 bit randInt(), that they resolve below 2^-32. */
+      template < typename RNG >
+      inline void testRand53() {
+        RNG r( 54321u );
+        const int n = 100000;
+        int n_bad = 0, n_fine = 0;
+        for ( int i = 0; i < n; ++i ) {
+          const double u = r.rand53(), e = r.randExc53(), d = r.randDblExc53();
+          n_bad += ( u < 0.0 || u > 1.0 || e < 0.0 || e >= 1.0 ||
+                     d <= 0.0 || d >= 1.0 );
+          /* bits below 2^-32 */
+          n_fine += ( std::fmod( e * 4294967296.0, 1.0 ) != 0.0 );
+        }
+        BOOST_CHECK_EQUAL( n_bad, 0 );
+        if ( static_cast<uint32_t>(RNG::rand_max) == static_cast<uint32_t>(-1) )
+          BOOST_CHECK_GT( n_fine, n / 2 );
+      }
+
       /** Run the tests defined above. */
       template < typename RNG >
       inline void run( const std::string & label,
@@ -184,7 +264,10 @@ namespace xylose {
 
         generate_files<RNG>(label, total_rolls);
         testRandExc<RNG>(total_rolls, test_first_roll);
+        testBulk<RNG>();
+        testRand53<RNG>();
         timeRNG<RNG>();
+        timeRNGBulk<RNG>();
       }
 
     }/* namespace xylose::random::test */
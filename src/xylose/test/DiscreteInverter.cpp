@@ -0,0 +1,162 @@
+/*==============================================================================
+ * Public Domain Contributions 2010 United States Government                   *
+ * as represented by the U.S. Air Force Research Laboratory.                   *
+ *                                                                             *
+ * This file is part of xylose                                                 *
+ *                                                                             *
+ * This program is free software: you can redistribute it and/or modify it     *
+ * under the terms of the GNU Lesser General Public License as published by    *
+ * the Free Software Foundation, either version 3 of the License, or (at your  *
+ * option) any later version.                                                  *
+ *                                                                             *
+ * This program is distributed in the hope that it will be useful, but WITHOUT *
+ * ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or       *
+ * FITNESS FOR A PARTICULAR PURPOSE.  See the GNU Lesser General Public        *
+ * License for more details.                                                   *
+ *                                                                             *
+ * You should have received a copy of the GNU Lesser General Public License    *
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.       *
+ *                                                                             *
+ -----------------------------------------------------------------------------*/
+
+#define BOOST_TEST_MODULE DiscreteInverter
+
+#include <xylose/distribution/DiscreteInverter.h>
+#include <xylose/random/Kiss.hpp>
+
+#include <boost/test/unit_test.hpp>
+
+#include <vector>
+#include <map>
+#include <utility>
+#include <sstream>
+
+namespace {
+  namespace dist = xylose::distribution;
+  typedef dist::DiscreteInverter<xylose::random::Kiss,true> Inverter;
+
+  std::vector< std::pair<double,double> > makePv() {
+    std::vector< std::pair<double,double> > Pv;
+                              //  v, P(v)
+    Pv.push_back( std::make_pair( 1, 0.5 ) );
+    Pv.push_back( std::make_pair( 2, 0.5 ) );
+    Pv.push_back( std::make_pair( 3, 0.1 ) );
+    Pv.push_back( std::make_pair( 4, 0.0 ) );
+    Pv.push_back( std::make_pair( 6, 0.7 ) );
+    Pv.push_back( std::make_pair( 7, 0.4 ) );
+    Pv.push_back( std::make_pair( 8, 0.3 ) );
+    Pv.push_back( std::make_pair(10, 0.5 ) );
+    return Pv;
+  }
+
+  /* the inverse cdf lookups with std::map (as the tables must give). */
+  double mapDiscreteValue( const std::map<double,double> & m, const double & rf ) {
+    std::map<double,double>::const_iterator i = m.lower_bound( rf );
+    return i == m.end() ? m.rbegin()->second : i->second;
+  }
+
+  double mapLeverarm( const std::map<double,double> & m, const double & rf ) {
+    typedef std::map<double,double>::const_iterator Iter;
+    Iter i = m.upper_bound( rf );
+    if ( i == m.begin() )
+      return i->second;
+    else if ( i == m.end() )
+      return m.rbegin()->second;
+    Iter i0 = i;
+    --i0;
+    return ( i->second*(rf - i0->first) + i0->second*(i->first - rf) ) /
+           ( i->first - i0->first );
+  }
+
+  /* P(v) of the alias table, integrated over rf on a fine grid. */
+  std::map<double,double> aliasMass( const Inverter & inv ) {
+    const int N = 1000000;
+    std::map<double,double> m;
+    for ( int k = 0; k < N; ++k )
+      m[ inv.alias_value( (k + 0.5) / N ) ] += 1.0 / N;
+    return m;
+  }
+}
+
+BOOST_AUTO_TEST_SUITE( DiscreteInverter );
+
+BOOST_AUTO_TEST_CASE( alias_table ) {
+  std::vector< std::pair<double,double> > Pv = makePv();
+  xylose::random::Kiss rng(1u);
+  const Inverter inv( Pv.begin(), Pv.end(), rng );
+
+  double total = 0.0;
+  for ( unsigned int i = 0u; i < Pv.size(); ++i )
+    total += Pv[i].second;
+
+  std::map<double,double> m = aliasMass( inv );
+  BOOST_CHECK_EQUAL( m.size(), 7u );
+  BOOST_CHECK( m.find(4.0) == m.end() );
+  for ( unsigned int i = 0u; i < Pv.size(); ++i )
+    if ( Pv[i].second > 0.0 )
+      BOOST_CHECK_CLOSE( m[Pv[i].first], Pv[i].second / total, 1e-2 );
+
+  /* the same table from the probability map and from a stream. */
+  const Inverter inv2( inv.invertedDistribution(), rng );
+  std::ostringstream data;
+  for ( unsigned int i = 0u; i < Pv.size(); ++i )
+    data << Pv[i].first << ' ' << Pv[i].second << '\n';
+  std::istringstream in( data.str() );
+  const Inverter inv3( in, rng );
+  for ( int k = 0; k < 1000; ++k ) {
+    const double rf = (k + 0.5) / 1000;
+    BOOST_CHECK_EQUAL( inv2.alias_value(rf), inv.alias_value(rf) );
+    BOOST_CHECK_EQUAL( inv3.alias_value(rf), inv.alias_value(rf) );
+  }
+}
+
+BOOST_AUTO_TEST_CASE( inverse_cdf ) {
+  std::vector< std::pair<double,double> > Pv = makePv();
+  xylose::random::Kiss rng(1u);
+  const Inverter inv( Pv.begin(), Pv.end(), rng );
+  const std::map<double,double> & m = inv.invertedDistribution();
+
+  /* a grid of fractions, including the steps of the cdf and values just out
+   * of range. */
+  std::vector<double> rf;
+  for ( int k = -10; k <= 1010; ++k )
+    rf.push_back( k / 1000.0 );
+  for ( std::map<double,double>::const_iterator i = m.begin(); i != m.end(); ++i )
+    rf.push_back( i->first );
+
+  for ( unsigned int i = 0u; i < rf.size(); ++i ) {
+    BOOST_CHECK_EQUAL( inv.discrete_value(rf[i]), mapDiscreteValue(m, rf[i]) );
+    BOOST_CHECK_CLOSE( inv.leverarm(rf[i]), mapLeverarm(m, rf[i]), 1e-12 );
+  }
+}
+
+BOOST_AUTO_TEST_CASE( single_value ) {
+  std::vector< std::pair<double,double> > Pv( 1u, std::make_pair(3.0, 2.0) );
+  xylose::random::Kiss rng(1u);
+  const Inverter inv( Pv.begin(), Pv.end(), rng );
+  for ( int i = 0; i < 100; ++i )
+    BOOST_CHECK_EQUAL( inv(), 3.0 );
+}
+
+BOOST_AUTO_TEST_CASE( bulk ) {
+  std::vector< std::pair<double,double> > Pv = makePv();
+  xylose::random::Kiss r0(2u), r1(2u);
+  const Inverter i0( Pv.begin(), Pv.end(), r0 ), i1( Pv.begin(), Pv.end(), r1 );
+
+  std::vector<double> v(1000);
+  BOOST_CHECK( i0.generate_n( v.begin(), v.size() ) == v.end() );
+  for ( unsigned int i = 0u; i < v.size(); ++i )
+    BOOST_CHECK_EQUAL( v[i], i1.discrete() );
+
+  /* the sampled frequencies. */
+  const int n = 1000000;
+  std::vector<double> w(n);
+  i0.fill( w.begin(), w.end() );
+  std::map<double,double> m;
+  for ( int i = 0; i < n; ++i )
+    m[ w[i] ] += 1.0 / n;
+  BOOST_CHECK_CLOSE( m[6.0], 0.7 / 3.0, 1.0 );
+  BOOST_CHECK_CLOSE( m[3.0], 0.1 / 3.0, 3.0 );
+}
+
+BOOST_AUTO_TEST_SUITE_END();
@@ -0,0 +1,109 @@
+/*==============================================================================
+ * Public Domain Contributions 2010 United States Government                   *
+ * as represented by the U.S. Air Force Research Laboratory.                   *
+ *                                                                             *
+ * This file is part of xylose                                                 *
+ *                                                                             *
+ * This program is free software: you can redistribute it and/or modify it     *
+ * under the terms of the GNU Lesser General Public License as published by    *
+ * the Free Software Foundation, either version 3 of the License, or (at your  *
+ * option) any later version.                                                  *
+ *                                                                             *
+ * This program is distributed in the hope that it will be useful, but WITHOUT *
+ * ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or       *
+ * FITNESS FOR A PARTICULAR PURPOSE.  See the GNU Lesser General Public        *
+ * License for more details.                                                   *
+ *                                                                             *
+ * You should have received a copy of the GNU Lesser General Public License    *
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.       *
+ *                                                                             *
+ -----------------------------------------------------------------------------*/
+
+#define BOOST_TEST_MODULE Inverter
+
+#include <xylose/distribution/Inverter.h>
+#include <xylose/distribution/Gaussian.h>
+#include <xylose/random/Kiss.hpp>
+#include <xylose/random/MersenneTwister.hpp>
+#include <xylose/Timer.h>
+
+#include <boost/test/unit_test.hpp>
+
+#include <vector>
+#include <list>
+#include <cmath>
+
+namespace {
+  namespace dist = xylose::distribution;
+}
+
+BOOST_AUTO_TEST_SUITE( Inverter );
+
+BOOST_AUTO_TEST_CASE( array_leverarm ) {
+  xylose::random::Kiss rng(1u);
+  const dist::Inverter<> inv( dist::Gaussian(0.5), -6.0, 6.0, 1000, rng );
+
+  std::vector<double> rf(1001), out(rf.size());
+  for ( unsigned int i = 0u; i < rf.size(); ++i )
+    rf[i] = i / 1001.0;
+  inv.leverarm( &rf[0], rf.size(), &out[0] );
+  for ( unsigned int i = 0u; i < rf.size(); ++i )
+    BOOST_CHECK_EQUAL( out[i], inv.leverarm(rf[i]) );
+
+  /* in place. */
+  inv.leverarm( &rf[0], rf.size(), &rf[0] );
+  BOOST_CHECK( rf == out );
+}
+
+BOOST_AUTO_TEST_CASE( sample ) {
+  typedef xylose::random::MersenneTwister MT;
+  MT r0(2u), r1(2u);
+  const dist::Inverter<MT> i0( dist::Gaussian(0.5), -6.0, 6.0, 1000, r0 );
+  const dist::Inverter<MT> i1( dist::Gaussian(0.5), -6.0, 6.0, 1000, r1 );
+
+  /* the same numbers as single calls (also through a list iterator). */
+  std::vector<double> v(1000);
+  BOOST_CHECK( i0.generate_n( v.begin(), 600u ) == v.begin() + 600 );
+  std::list<double> l(400u);
+  i0.sample( l.begin(), l.end() );
+  std::copy( l.begin(), l.end(), v.begin() + 600 );
+  for ( unsigned int i = 0u; i < v.size(); ++i )
+    BOOST_CHECK_EQUAL( v[i], i1() );
+
+  /* exp(-0.5 v^2):  unit variance (up to the discretization of the
+   * inversion, with bins of width 0.012). */
+  const int n = 2000000;
+  std::vector<double> x(n);
+  i0.sample( x.begin(), x.end() );
+  double s1 = 0, s2 = 0;
+  for ( int i = 0; i < n; ++i ) {
+    s1 += x[i];
+    s2 += x[i] * x[i];
+  }
+  BOOST_CHECK_SMALL( s1 / n, 0.012 );
+  BOOST_CHECK_CLOSE( s2 / n - (s1/n)*(s1/n), 1.0, 3.0 );
+}
+
+BOOST_AUTO_TEST_CASE( timing ) {
+  xylose::random::Kiss rng(3u);
+  const dist::Inverter<> inv( dist::Gaussian(0.5), -6.0, 6.0, 1000, rng );
+
+  const int n = 10000000;
+  std::vector<double> x(n);
+  xylose::Timer timer;
+
+  timer.start();
+  for ( int i = 0; i < n; ++i )
+    x[i] = inv();
+  timer.stop();
+  const double t_s = timer.dt;
+
+  timer.start();
+  inv.sample( x.begin(), x.end() );
+  timer.stop();
+
+  BOOST_TEST_MESSAGE( "samples/s:  operator() " << n / t_s
+                   << ", sample " << n / timer.dt );
+}
+
+BOOST_AUTO_TEST_SUITE_END();